@@ -0,0 +1,10 @@
+#!/bin/sh
+
+# Builds with heap allocation counting in its own build directory and runs the headless frame
+# loop under --fail-on-allocation, for the clock face and every animation
+set -e
+
+BUILD_DIR=${1:-build-allocations}
+cmake -S . -B "$BUILD_DIR" -DLED_CLOCK_COUNT_ALLOCATIONS=ON -DBUILD_SHARED_LIBS=FALSE
+cmake --build "$BUILD_DIR" --target LEDMatrixClock -j"$(nproc)"
+ctest --test-dir "$BUILD_DIR" --output-on-failure -L allocations
@@ -0,0 +1,96 @@
+#include "animations/animation_clip.h"
+
+#include <cstring>
+#include <unordered_map>
+
+std::unique_ptr<AnimationClip> AnimationClip::Record(Animation &animation, int width, int height, int frames) {
+    std::unique_ptr<AnimationClip> clip(new AnimationClip(width, height));
+    std::vector<Color> pixels(width * height, BLACK);
+    PixelSpan span{pixels.data(), width, height, width};
+    clip->frames_.reserve(frames);
+    animation.Reset();
+    for (int i = 0; i < frames; ++i) {
+        animation.RenderTo(span);
+        clip->Encode(span);
+        animation.Update(Animation::kStep);
+    }
+    clip->data_.shrink_to_fit();
+    return clip;
+}
+
+int AnimationClip::FrameCount() const {
+    return (int)frames_.size();
+}
+
+size_t AnimationClip::Bytes() const {
+    return data_.capacity() + frames_.capacity() * sizeof(Frame);
+}
+
+void AnimationClip::Encode(const PixelSpan &pixels) {
+    Frame frame{data_.size(), 0};
+
+    // Palette in order of first appearance, given up on past 256 colors
+    std::unordered_map<uint32_t, int> indices;
+    std::vector<Color> palette;
+    for (int y = 0; y < height_ && palette.size() <= 256; ++y) {
+        const Color* row = pixels.Row(y);
+        for (int x = 0; x < width_ && palette.size() <= 256; ++x) {
+            uint32_t key = (uint32_t)row[x].r | ((uint32_t)row[x].g << 8) | ((uint32_t)row[x].b << 16);
+            if (indices.emplace(key, (int)palette.size()).second) {
+                palette.push_back(row[x]);
+            }
+        }
+    }
+
+    size_t pixelCount = (size_t)width_ * height_;
+    if (palette.size() <= 256 && palette.size() * sizeof(Color) + pixelCount < pixelCount * 3) {
+        frame.paletteSize = (int)palette.size();
+        data_.resize(frame.offset + palette.size() * sizeof(Color) + pixelCount);
+        uint8_t* out = data_.data() + frame.offset;
+        std::memcpy(out, palette.data(), palette.size() * sizeof(Color));
+        out += palette.size() * sizeof(Color);
+        for (int y = 0; y < height_; ++y) {
+            const Color* row = pixels.Row(y);
+            for (int x = 0; x < width_; ++x) {
+                uint32_t key = (uint32_t)row[x].r | ((uint32_t)row[x].g << 8) | ((uint32_t)row[x].b << 16);
+                *out++ = (uint8_t)indices[key];
+            }
+        }
+    } else {
+        data_.resize(frame.offset + pixelCount * 3);
+        uint8_t* out = data_.data() + frame.offset;
+        for (int y = 0; y < height_; ++y) {
+            const Color* row = pixels.Row(y);
+            for (int x = 0; x < width_; ++x) {
+                *out++ = row[x].r;
+                *out++ = row[x].g;
+                *out++ = row[x].b;
+            }
+        }
+    }
+    frames_.push_back(frame);
+}
+
+void AnimationClip::Decode(int index, const PixelSpan &pixels) const {
+    const Frame &frame = frames_[index];
+    const uint8_t* in = data_.data() + frame.offset;
+    if (frame.paletteSize > 0) {
+        Color palette[256];
+        std::memcpy(palette, in, frame.paletteSize * sizeof(Color));
+        in += frame.paletteSize * sizeof(Color);
+        for (int y = 0; y < height_; ++y) {
+            Color* row = pixels.Row(y);
+            for (int x = 0; x < width_; ++x) {
+                row[x] = palette[*in++];
+            }
+        }
+    } else {
+        for (int y = 0; y < height_; ++y) {
+            Color* row = pixels.Row(y);
+            for (int x = 0; x < width_; ++x) {
+                row[x] = Color{in[0], in[1], in[2], 255};
+                in += 3;
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "animations/animations.h"
+#include "render/pixel_span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A looping animation rendered ahead of time, one frame per fixed step. Every frame stands alone,
+// because at 5 FPS playback skips most of them. Each is stored whichever way is smaller: up to
+// 256 colors as a palette plus a byte per pixel, otherwise as packed RGB (pixel animations are
+// opaque, so alpha is not kept).
+class AnimationClip {
+public:
+    // Resets `animation` and renders `frames` steps of it; frame k is the state after k steps.
+    // The animation must render pixels.
+    static std::unique_ptr<AnimationClip> Record(Animation &animation, int width, int height, int frames);
+
+    int FrameCount() const;
+    // Memory held by the encoded frames
+    size_t Bytes() const;
+
+    // Writes frame `index` into `pixels`, which must be the clip's size
+    void Decode(int index, const PixelSpan &pixels) const;
+
+private:
+    struct Frame {
+        size_t offset;
+        // 0 for packed RGB
+        int paletteSize;
+    };
+
+    AnimationClip(int width, int height) : width_(width), height_(height) {}
+
+    void Encode(const PixelSpan &pixels);
+
+    int width_;
+    int height_;
+    std::vector<Frame> frames_;
+    std::vector<uint8_t> data_;
+};
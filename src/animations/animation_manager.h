@@ -1,10 +1,16 @@
 #pragma once
 
 #include "animations.h"
+#include "animations/clip_cache.h"
+#include "animations/request_queue.h"
+#include "metrics/clock_metrics.h"
 #include "third_party/httplib.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -15,41 +21,130 @@
 
 #include <nlohmann/json.hpp>
 
+// A claim on the animation slot: catalogue entries played in order, each for `duration`. A
+// request with a higher priority interrupts a lower one, which resumes the entry it was on, for
+// the time that entry had left, once the slot is free again; equal priorities play first come,
+// first served.
+struct AnimationRequest {
+    static const int kMaxPlaylist = 8;
+
+    std::array<uint8_t, kMaxPlaylist> playlist{};
+    int playlistLength = 0;
+    // Playlist entry to play next
+    int position = 0;
+    std::chrono::milliseconds duration{8000};
+    // What was left of the entry at `position` when it was interrupted; zero plays it in full
+    std::chrono::milliseconds remaining{0};
+    int priority = 0;
+    // Assigned by AnimationManager::Submit(), increasing
+    uint32_t id = 0;
+};
+
 class AnimationManager {
 public:
-    AnimationManager(int width, int height);
+    enum class SubmitResult { Accepted, QueueFull, Invalid };
+
+    // What the render thread is doing, as last published at the end of Update()
+    struct Status {
+        std::optional<size_t> active;
+        // Request the active animation belongs to
+        uint32_t activeRequest = 0;
+        // Requests waiting their turn
+        uint32_t queued = 0;
+        // Refused because the queue was full, and dropped to make room for higher priorities
+        uint64_t rejected = 0;
+        uint64_t dropped = 0;
+    };
+
+    // Looping animations are recorded into clips of up to `clipBudgetBytes` in total (0 disables
+    // clips) and played back from those instead of being rendered
+    AnimationManager(int width, int height, size_t clipBudgetBytes = kDefaultClipBudget);
     ~AnimationManager() = default;
 
     AnimationManager(const AnimationManager &) = delete;
     AnimationManager &operator=(const AnimationManager &) = delete;
 
+    // Advances the active animation by the wall time since the last call, in fixed steps of
+    // Animation::kStep. Whatever is left over carries into the next call. The call that starts an
+    // animation and the one after it do not advance it: their frame times were measured from
+    // frames drawn before it started, possibly before an idle sleep.
     void Update(float dt);
-    void Render(RenderTexture2D &target);
+    void Render(Canvas &canvas);
+    // Render thread only
     bool IsActive() const;
-
-    bool RequestAnimationByName(const std::string &name);
+    // Render thread only; nullptr while the clock face is showing
+    const char *ActiveAnimationName() const;
+
+    // Any thread. Checks the request, stamps its id and queues it for the render thread; never
+    // blocks. A burst beyond kQueueCapacity + kPendingCapacity waiting requests is refused.
+    SubmitResult Submit(AnimationRequest &request);
+    // Any thread
+    Status CurrentStatus() const;
+
+    // Any thread: the catalogue is fixed at construction
+    std::optional<size_t> FindAnimation(const std::string &name) const;
+    const std::string &AnimationName(size_t index) const;
     std::vector<std::string> AnimationNames() const;
 
+    static const size_t kDefaultClipBudget = 4 << 20;
+    static const size_t kQueueCapacity = 16;
+    static const size_t kPendingCapacity = 16;
+
 private:
     struct Entry {
         std::string name;
         std::unique_ptr<Animation> animation;
+        // Another instance, for recording its clip off the render thread
+        ClipCache::Factory create;
     };
 
-    void StartAnimation(size_t index);
+    void AddAnimation(const char *name, ClipCache::Factory create);
+
+    void StartAnimation(size_t index, std::chrono::milliseconds duration);
+    // Starts the current request's entry at its position
+    void StartCurrent();
     void StopAnimation();
+    // Plays the current request's next entry, or the next request, or returns to the clock face
+    void Advance();
+    void QueuePending(const AnimationRequest &request);
+    AnimationRequest TakePending();
+    void PublishStatus();
 
     int width_;
     int height_;
     std::vector<Entry> animations_;
     std::unordered_map<std::string, size_t> lookup_;
-
-    mutable std::mutex mutex_;
+    // Frame buffer for animations that render pixels directly
+    std::vector<Color> pixels_;
+    // Simulated time owed to the active animation, less than one step after Update()
+    float accumulator_ = 0.0f;
+    // Set when an animation starts: the next frame time still spans the frame drawn before it
+    bool ignoreNextDt_ = false;
+    ClipCache clips_;
+    // Playing instead of the active animation when it has a clip
+    std::shared_ptr<const AnimationClip> clip_;
+    int clipFrame_ = 0;
+    // Beyond this many steps in one Update() (half a second) the backlog is dropped: a stalled
+    // frame should not be followed by a burst of simulation
+    static constexpr int kMaxStepsPerUpdate = 15;
+
+    // Producers to render thread
+    BoundedMpscQueue<AnimationRequest, kQueueCapacity> queue_;
+    std::atomic<uint32_t> nextRequestId_{1};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> rejected_{0};
+
+    // Render thread: taken off the queue and waiting, highest priority first, then oldest first
+    std::array<AnimationRequest, kPendingCapacity> pending_;
+    size_t pendingCount_ = 0;
+    uint64_t taken_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+    std::optional<AnimationRequest> current_;
     std::optional<size_t> activeIndex_;
-    std::optional<size_t> pendingIndex_;
     std::chrono::steady_clock::time_point endTime_;
-    const std::chrono::milliseconds animationDuration_{8000};
-    bool active_ = false;
+
+    // Active index + 1 (0 for none) in bits 0-7, queued count in bits 8-23, request id above
+    std::atomic<uint64_t> status_{0};
 };
 
 class AnimationRequestServer {
@@ -60,6 +155,9 @@ public:
     AnimationRequestServer(const AnimationRequestServer &) = delete;
     AnimationRequestServer &operator=(const AnimationRequestServer &) = delete;
 
+    // Enables GET /api/metrics; must be called before Start()
+    void SetMetrics(const ClockMetrics *metrics);
+
     void Start();
     void Stop();
 
@@ -67,6 +165,7 @@ private:
     void RegisterRoutes();
 
     AnimationManager &manager_;
+    const ClockMetrics *metrics_ = nullptr;
     int port_;
     httplib::Server server_;
     std::thread worker_;
@@ -74,70 +173,164 @@ private:
     std::once_flag routeInitFlag_;
 };
 
-inline AnimationManager::AnimationManager(int width, int height)
-    : width_(width), height_(height) {
-    animations_.push_back({"rainbow_cycle", std::make_unique<RainbowCycleAnimation>(width_, height_)});
-    animations_.push_back({"matrix_rain", std::make_unique<MatrixRainAnimation>(width_, height_)});
-    animations_.push_back({"starfield", std::make_unique<StarfieldAnimation>(width_, height_)});
-    animations_.push_back({"swirl", std::make_unique<SwirlAnimation>(width_, height_)});
-    animations_.push_back({"bouncing_balls", std::make_unique<BouncingBallAnimation>(width_, height_)});
-    animations_.push_back({"wave_lines", std::make_unique<WaveLinesAnimation>(width_, height_)});
-    animations_.push_back({"sparkle", std::make_unique<SparkleAnimation>(width_, height_)});
-    animations_.push_back({"fire", std::make_unique<FireAnimation>(width_, height_)});
-    animations_.push_back({"pulse_squares", std::make_unique<PulseSquaresAnimation>(width_, height_)});
-    animations_.push_back({"scrolling_text", std::make_unique<ScrollingTextAnimation>(width_, height_, "LED MATRIX" )});
-
+inline AnimationManager::AnimationManager(int width, int height, size_t clipBudgetBytes)
+    : width_(width), height_(height), pixels_(width * height, BLACK), clips_(width, height, clipBudgetBytes) {
+    AddAnimation("rainbow_cycle", [=]() { return std::make_unique<RainbowCycleAnimation>(width, height); });
+    AddAnimation("matrix_rain", [=]() { return std::make_unique<MatrixRainAnimation>(width, height); });
+    AddAnimation("starfield", [=]() { return std::make_unique<StarfieldAnimation>(width, height); });
+    AddAnimation("swirl", [=]() { return std::make_unique<SwirlAnimation>(width, height); });
+    AddAnimation("bouncing_balls", [=]() { return std::make_unique<BouncingBallAnimation>(width, height); });
+    AddAnimation("wave_lines", [=]() { return std::make_unique<WaveLinesAnimation>(width, height); });
+    AddAnimation("sparkle", [=]() { return std::make_unique<SparkleAnimation>(width, height); });
+    AddAnimation("fire", [=]() { return std::make_unique<FireAnimation>(width, height); });
+    AddAnimation("pulse_squares", [=]() { return std::make_unique<PulseSquaresAnimation>(width, height); });
+    AddAnimation("scrolling_text", [=]() { return std::make_unique<ScrollingTextAnimation>(width, height, "LED MATRIX"); });
+
+    // Record the clips at startup, in the background, so the first request already finds them
     for (size_t i = 0; i < animations_.size(); ++i) {
-        lookup_.emplace(animations_[i].name, i);
-        animations_[i].animation->Reset();
+        const Entry &entry = animations_[i];
+        if (entry.animation->RendersPixels()) {
+            clips_.Prepare(i, entry.name, entry.create, entry.animation->LoopSteps());
+        }
     }
 }
 
+inline void AnimationManager::AddAnimation(const char *name, ClipCache::Factory create) {
+    std::unique_ptr<Animation> animation = create();
+    animation->Reset();
+    lookup_.emplace(name, animations_.size());
+    animations_.push_back({name, std::move(animation), std::move(create)});
+}
+
 inline void AnimationManager::Update(float dt) {
-    std::optional<size_t> request;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pendingIndex_) {
-            request = pendingIndex_;
-            pendingIndex_.reset();
-        }
+    // Take new requests while there is room to order them. The rest wait in the queue, which
+    // refuses producers once it fills too.
+    if (ignoreNextDt_) {
+        dt = 0.0f;
+        ignoreNextDt_ = false;
     }
 
-    if (request.has_value()) {
-        StartAnimation(request.value());
+    AnimationRequest request;
+    while (pendingCount_ < kPendingCapacity && queue_.TryPop(request)) {
+        ++taken_;
+        QueuePending(request);
+    }
+
+    if (current_.has_value() && pendingCount_ > 0 && pending_[0].priority > current_->priority) {
+        // Taking the interrupting request first leaves room to put the interrupted one back
+        AnimationRequest next = TakePending();
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(endTime_ - std::chrono::steady_clock::now());
+        current_->remaining = std::max(left, std::chrono::milliseconds(1));
+        QueuePending(*current_);
+        current_ = next;
+        StartCurrent();
+        dt = 0.0f;
+    } else if (!current_.has_value() && pendingCount_ > 0) {
+        current_ = TakePending();
+        StartCurrent();
+        // dt is time spent before the animation existed, likely an idle sleep
+        dt = 0.0f;
     }
 
     if (activeIndex_.has_value()) {
-        animations_[activeIndex_.value()].animation->Update(dt);
+        Animation &animation = *animations_[activeIndex_.value()].animation;
+        accumulator_ += dt;
+        int steps = 0;
+        while (accumulator_ >= Animation::kStep && steps < kMaxStepsPerUpdate) {
+            if (clip_) {
+                clipFrame_ = (clipFrame_ + 1) % clip_->FrameCount();
+            } else {
+                animation.Update(Animation::kStep);
+            }
+            accumulator_ -= Animation::kStep;
+            ++steps;
+        }
+        if (accumulator_ >= Animation::kStep) {
+            accumulator_ = std::fmod(accumulator_, Animation::kStep);
+        }
         if (std::chrono::steady_clock::now() >= endTime_) {
-            StopAnimation();
+            Advance();
         }
     }
+    PublishStatus();
 }
 
-inline void AnimationManager::Render(RenderTexture2D &target) {
-    BeginTextureMode(target);
-    ClearBackground(BLACK);
-    if (activeIndex_.has_value()) {
-        animations_[activeIndex_.value()].animation->DrawFrame();
+inline void AnimationManager::Render(Canvas &canvas) {
+    if (!activeIndex_.has_value()) {
+        canvas.Clear(BLACK);
+        return;
+    }
+    Animation &animation = *animations_[activeIndex_.value()].animation;
+    animation.SetStepFraction(accumulator_ / Animation::kStep);
+    if (clip_) {
+        PixelSpan span{pixels_.data(), width_, height_, width_};
+        clip_->Decode(clipFrame_, span);
+        canvas.WritePixels(span);
+    } else if (animation.RendersPixels()) {
+        PixelSpan span{pixels_.data(), width_, height_, width_};
+        animation.RenderTo(span);
+        canvas.WritePixels(span);
+    } else {
+        canvas.Clear(BLACK);
+        animation.DrawFrame(canvas);
     }
-    EndTextureMode();
 }
 
 inline bool AnimationManager::IsActive() const {
-    return active_;
+    return activeIndex_.has_value();
+}
+
+inline const char *AnimationManager::ActiveAnimationName() const {
+    if (!activeIndex_.has_value()) {
+        return nullptr;
+    }
+    return animations_[activeIndex_.value()].animation->Name();
+}
+
+inline AnimationManager::SubmitResult AnimationManager::Submit(AnimationRequest &request) {
+    if (request.playlistLength < 1 || request.playlistLength > AnimationRequest::kMaxPlaylist ||
+        request.duration.count() <= 0) {
+        return SubmitResult::Invalid;
+    }
+    for (int i = 0; i < request.playlistLength; ++i) {
+        if (request.playlist[i] >= animations_.size()) {
+            return SubmitResult::Invalid;
+        }
+    }
+    request.position = 0;
+    request.remaining = std::chrono::milliseconds(0);
+    request.id = nextRequestId_.fetch_add(1, std::memory_order_relaxed);
+    if (!queue_.TryPush(request)) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return SubmitResult::QueueFull;
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    return SubmitResult::Accepted;
+}
+
+inline AnimationManager::Status AnimationManager::CurrentStatus() const {
+    uint64_t packed = status_.load(std::memory_order_acquire);
+    Status status;
+    if ((packed & 0xFF) != 0) {
+        status.active = (packed & 0xFF) - 1;
+    }
+    status.queued = (packed >> 8) & 0xFFFF;
+    status.activeRequest = (uint32_t)(packed >> 24);
+    status.rejected = rejected_.load(std::memory_order_relaxed);
+    status.dropped = dropped_.load(std::memory_order_relaxed);
+    return status;
 }
 
-inline bool AnimationManager::RequestAnimationByName(const std::string &name) {
+inline std::optional<size_t> AnimationManager::FindAnimation(const std::string &name) const {
     auto it = lookup_.find(name);
     if (it == lookup_.end()) {
-        return false;
-    }
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        pendingIndex_ = it->second;
+        return std::nullopt;
     }
-    return true;
+    return it->second;
+}
+
+inline const std::string &AnimationManager::AnimationName(size_t index) const {
+    return animations_[index].name;
 }
 
 inline std::vector<std::string> AnimationManager::AnimationNames() const {
@@ -149,19 +342,90 @@ inline std::vector<std::string> AnimationManager::AnimationNames() const {
     return names;
 }
 
-inline void AnimationManager::StartAnimation(size_t index) {
-    if (index >= animations_.size()) {
-        return;
+inline void AnimationManager::StartAnimation(size_t index, std::chrono::milliseconds duration) {
+    const Entry &entry = animations_[index];
+    clip_.reset();
+    clipFrame_ = 0;
+    if (entry.animation->RendersPixels() && entry.animation->LoopSteps() > 0) {
+        clip_ = clips_.Find(index);
+        if (!clip_) {
+            // Still recording, or evicted: render this time and have it ready for the next
+            clips_.Prepare(index, entry.name, entry.create, entry.animation->LoopSteps());
+        }
     }
-    animations_[index].animation->Reset();
+    entry.animation->Reset();
+    accumulator_ = 0.0f;
+    ignoreNextDt_ = true;
     activeIndex_ = index;
-    active_ = true;
-    endTime_ = std::chrono::steady_clock::now() + animationDuration_;
+    endTime_ = std::chrono::steady_clock::now() + duration;
+}
+
+inline void AnimationManager::StartCurrent() {
+    std::chrono::milliseconds duration = current_->remaining.count() > 0 ? current_->remaining : current_->duration;
+    current_->remaining = std::chrono::milliseconds(0);
+    StartAnimation(current_->playlist[current_->position], duration);
 }
 
 inline void AnimationManager::StopAnimation() {
     activeIndex_.reset();
-    active_ = false;
+    clip_.reset();
+}
+
+inline void AnimationManager::Advance() {
+    if (current_.has_value() && ++current_->position < current_->playlistLength) {
+        StartCurrent();
+        return;
+    }
+    current_.reset();
+    if (pendingCount_ > 0) {
+        current_ = TakePending();
+        StartCurrent();
+    } else {
+        StopAnimation();
+    }
+}
+
+inline void AnimationManager::QueuePending(const AnimationRequest &request) {
+    auto before = [](const AnimationRequest &a, const AnimationRequest &b) {
+        return a.priority > b.priority || (a.priority == b.priority && a.id < b.id);
+    };
+    size_t slot = 0;
+    while (slot < pendingCount_ && !before(request, pending_[slot])) {
+        ++slot;
+    }
+    if (pendingCount_ == kPendingCapacity) {
+        // Full: whichever ranks last goes, the new request or the current last one
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (slot == pendingCount_) {
+            return;
+        }
+        --pendingCount_;
+    }
+    for (size_t i = pendingCount_; i > slot; --i) {
+        pending_[i] = pending_[i - 1];
+    }
+    pending_[slot] = request;
+    ++pendingCount_;
+}
+
+inline AnimationRequest AnimationManager::TakePending() {
+    AnimationRequest request = pending_[0];
+    for (size_t i = 1; i < pendingCount_; ++i) {
+        pending_[i - 1] = pending_[i];
+    }
+    --pendingCount_;
+    return request;
+}
+
+inline void AnimationManager::PublishStatus() {
+    // Requests pushed but not yet taken; submitted_ is bumped after the push, so it can briefly
+    // trail taken_
+    uint64_t submitted = submitted_.load(std::memory_order_relaxed);
+    uint64_t inQueue = (submitted > taken_) ? submitted - taken_ : 0;
+    uint64_t queued = std::min<uint64_t>(pendingCount_ + inQueue, 0xFFFF);
+    uint64_t active = activeIndex_.has_value() ? activeIndex_.value() + 1 : 0;
+    uint64_t request = current_.has_value() ? current_->id : 0;
+    status_.store(active | (queued << 8) | (request << 24), std::memory_order_release);
 }
 
 inline AnimationRequestServer::AnimationRequestServer(AnimationManager &manager, int port)
@@ -171,6 +435,10 @@ inline AnimationRequestServer::~AnimationRequestServer() {
     Stop();
 }
 
+inline void AnimationRequestServer::SetMetrics(const ClockMetrics *metrics) {
+    metrics_ = metrics;
+}
+
 inline void AnimationRequestServer::RegisterRoutes() {
     std::call_once(routeInitFlag_, [this]() {
         server_.Get("/api/animations", [this](const httplib::Request &, httplib::Response &res) {
@@ -179,32 +447,116 @@ inline void AnimationRequestServer::RegisterRoutes() {
             res.set_content(payload.dump(), "application/json");
         });
 
+        server_.Get("/api/animations/status", [this](const httplib::Request &, httplib::Response &res) {
+            AnimationManager::Status status = manager_.CurrentStatus();
+            nlohmann::json payload;
+            if (status.active.has_value()) {
+                payload["active"] = manager_.AnimationName(status.active.value());
+                payload["request"] = status.activeRequest;
+            } else {
+                payload["active"] = nullptr;
+                payload["request"] = nullptr;
+            }
+            payload["queued"] = status.queued;
+            payload["rejected"] = status.rejected;
+            payload["dropped"] = status.dropped;
+            res.set_content(payload.dump(), "application/json");
+        });
+
         server_.Post("/api/animations/run", [this](const httplib::Request &req, httplib::Response &res) {
             nlohmann::json response;
-            auto jsonBody = nlohmann::json::parse(req.body, nullptr, false);
-            if (jsonBody.is_discarded()) {
-                res.status = 400;
-                response["error"] = "Invalid JSON payload";
+            auto fail = [&](int status, const char *error) {
+                res.status = status;
+                response["error"] = error;
                 res.set_content(response.dump(), "application/json");
+            };
+            auto jsonBody = nlohmann::json::parse(req.body, nullptr, false);
+            if (jsonBody.is_discarded() || !jsonBody.is_object()) {
+                fail(400, "Invalid JSON payload");
                 return;
             }
-            if (!jsonBody.contains("animation") || !jsonBody["animation"].is_string()) {
-                res.status = 400;
-                response["error"] = "Missing 'animation' string field";
-                res.set_content(response.dump(), "application/json");
+
+            // Either one "animation" or a "playlist" of them
+            std::vector<std::string> names;
+            if (jsonBody.contains("playlist")) {
+                const auto &playlist = jsonBody["playlist"];
+                if (!playlist.is_array() || playlist.empty() || playlist.size() > AnimationRequest::kMaxPlaylist) {
+                    fail(400, "'playlist' must be an array of 1 to 8 animation names");
+                    return;
+                }
+                for (const auto &name : playlist) {
+                    if (!name.is_string()) {
+                        fail(400, "'playlist' must be an array of 1 to 8 animation names");
+                        return;
+                    }
+                    names.push_back(name.get<std::string>());
+                }
+            } else if (jsonBody.contains("animation") && jsonBody["animation"].is_string()) {
+                names.push_back(jsonBody["animation"].get<std::string>());
+            } else {
+                fail(400, "Missing 'animation' string field");
                 return;
             }
-            std::string requested = jsonBody["animation"].get<std::string>();
-            if (manager_.RequestAnimationByName(requested)) {
-                response["status"] = "accepted";
-                response["animation"] = requested;
-                response["duration_ms"] = 8000;
-                res.set_content(response.dump(), "application/json");
-            } else {
+
+            AnimationRequest request;
+            if (jsonBody.contains("duration_ms")) {
+                const auto &duration = jsonBody["duration_ms"];
+                if (!duration.is_number_integer() || duration.get<int64_t>() < 500 || duration.get<int64_t>() > 60000) {
+                    fail(400, "'duration_ms' must be an integer from 500 to 60000");
+                    return;
+                }
+                request.duration = std::chrono::milliseconds(duration.get<int64_t>());
+            }
+            if (jsonBody.contains("priority")) {
+                const auto &priority = jsonBody["priority"];
+                if (!priority.is_number_integer() || priority.get<int64_t>() < 0 || priority.get<int64_t>() > 9) {
+                    fail(400, "'priority' must be an integer from 0 to 9");
+                    return;
+                }
+                request.priority = priority.get<int>();
+            }
+            for (const std::string &name : names) {
+                std::optional<size_t> index = manager_.FindAnimation(name);
+                if (!index.has_value()) {
+                    response["available"] = manager_.AnimationNames();
+                    fail(404, "Unknown animation");
+                    return;
+                }
+                request.playlist[request.playlistLength++] = (uint8_t)index.value();
+            }
+
+            if (manager_.Submit(request) != AnimationManager::SubmitResult::Accepted) {
+                // Everything was validated above, so the only refusal left is a full queue
+                fail(429, "Animation queue is full");
+                return;
+            }
+            response["status"] = "accepted";
+            response["id"] = request.id;
+            response["animation"] = names.front();
+            response["playlist"] = names;
+            response["duration_ms"] = request.duration.count();
+            response["priority"] = request.priority;
+            res.set_content(response.dump(), "application/json");
+        });
+
+        server_.Get("/api/metrics", [this](const httplib::Request &req, httplib::Response &res) {
+            if (metrics_ == nullptr) {
                 res.status = 404;
-                response["error"] = "Unknown animation";
-                response["available"] = manager_.AnimationNames();
-                res.set_content(response.dump(), "application/json");
+                res.set_content(nlohmann::json{{"error", "Metrics are not enabled"}}.dump(), "application/json");
+                return;
+            }
+            // Prometheus scrapers ask for text/plain (or OpenMetrics); curl and browsers get JSON
+            std::string accept = req.get_header_value("Accept");
+            bool prometheus = req.get_param_value("format") == "prometheus" ||
+                              accept.find("text/plain") != std::string::npos ||
+                              accept.find("application/openmetrics-text") != std::string::npos;
+            if (req.get_param_value("format") == "json") {
+                prometheus = false;
+            }
+            if (prometheus) {
+                res.set_content(metrics_->toPrometheus(), "text/plain; version=0.0.4");
+            } else {
+                res.set_content(metrics_->toJson().dump(), "application/json");
             }
         });
     });
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "animations/particles.h"
+#include "animations/pixel_kernels.h"
 #include "raylib.h"
+#include "render/canvas.h"
 
 #include <algorithm>
 #include <array>
@@ -14,24 +17,56 @@ public:
     Animation(int width, int height) : width_(width), height_(height) {}
     virtual ~Animation() = default;
 
+    // Simulation step in seconds. AnimationManager calls Update() with exactly this dt, as many
+    // times as the elapsed wall time covers, so an animation looks the same at any frame rate.
+    static constexpr float kStep = 1.0f / 30.0f;
+
     virtual const char *Name() const = 0;
     virtual void Reset() = 0;
     virtual void Update(float dt) = 0;
-    virtual void DrawFrame() = 0;
+    // Draws onto a canvas that has been cleared to black
+    virtual void DrawFrame(Canvas &canvas) {}
+
+    // Animations that set every pixel themselves return true here and implement RenderTo()
+    // instead of DrawFrame(). They write straight into a row-major buffer the size of the matrix,
+    // which AnimationManager hands to the canvas in one go, rather than making one draw call per
+    // pixel. Every pixel has to be written; the buffer keeps the previous frame.
+    virtual bool RendersPixels() const { return false; }
+    virtual void RenderTo(PixelSpan &pixels) {}
+
+    // Pixel animations that come back to (to the eye) the same frame after a whole number of
+    // steps from Reset(), with no randomness, return that number here. AnimationManager then
+    // plays a clip recorded ahead of time (see ClipCache) instead of rendering them.
+    virtual int LoopSteps() const { return 0; }
+
+    // How far into the next step the frame being drawn is, from 0 to just under 1. Set before
+    // each DrawFrame() or RenderTo(); animations whose motion would visibly stutter when the
+    // frame rate beats the step rate draw that much further along.
+    void SetStepFraction(float fraction) { stepFraction_ = fraction; }
 
 protected:
+    // Seconds of simulation since the last Update()
+    float SinceUpdate() const { return stepFraction_ * kStep; }
+
     int width_;
     int height_;
+    float stepFraction_ = 0.0f;
 };
 
 class RainbowCycleAnimation : public Animation {
 public:
-    RainbowCycleAnimation(int width, int height) : Animation(width, height) { Reset(); }
+    RainbowCycleAnimation(int width, int height) : Animation(width, height), row_(width) {
+        std::fill(row_.value.begin(), row_.value.end(), 1.0f);
+        Reset();
+    }
 
     const char *Name() const override { return "rainbow_cycle"; }
 
     void Reset() override { phase_ = 0.0f; }
 
+    // The phase advances 0.12 * kStep = 1/250 per step
+    int LoopSteps() const override { return 250; }
+
     void Update(float dt) override {
         phase_ += dt * 0.12f;
         if (phase_ >= 1.0f) {
@@ -39,147 +74,148 @@ public:
         }
     }
 
-    void DrawFrame() override {
+    bool RendersPixels() const override { return true; }
+
+    void RenderTo(PixelSpan &pixels) override {
+        float phase = phase_ + SinceUpdate() * 0.12f;
         for (int y = 0; y < height_; ++y) {
             for (int x = 0; x < width_; ++x) {
-                float hue = std::fmod(((float)x / (float)width_) + phase_ + ((float)y / (float)(height_ * 2)), 1.0f);
-                Color color = ColorFromHSV(hue * 360.0f, 1.0f, 1.0f);
-                DrawPixel(x, y, color);
+                float hue = ((float)x / (float)width_) + phase + ((float)y / (float)(height_ * 2));
+                row_.hue[x] = (hue - std::floor(hue)) * 360.0f;
             }
+            row_.ConvertTo(pixels.Row(y), 1.0f);
         }
     }
 
 private:
     float phase_ = 0.0f;
+    pixel_kernels::HsvRow row_;
 };
 
 class MatrixRainAnimation : public Animation {
 public:
     MatrixRainAnimation(int width, int height)
-        : Animation(width, height), rng_(std::random_device{}()) {
+        : Animation(width, height), drops_((width + 1) / 2), rng_(std::random_device{}()) {
         Reset();
     }
 
     const char *Name() const override { return "matrix_rain"; }
 
+    // One drop per pair of columns; x and vx stay put, value is the trail length
     void Reset() override {
-        std::uniform_real_distribution<float> speed(8.0f, 20.0f);
-        std::uniform_int_distribution<int> length(6, 18);
-        columns_.clear();
-        columns_.reserve(width_ / 2);
-        for (int x = 0; x < width_; x += 2) {
-            columns_.push_back({static_cast<float>(GetRandomValue(-height_, height_)), speed(rng_), length(rng_), x});
+        drops_.Clear();
+        int first = drops_.Emit(drops_.Capacity());
+        for (int i = first; i < drops_.Size(); ++i) {
+            drops_.x[i] = static_cast<float>(i * 2);
+            drops_.vx[i] = 0.0f;
+            drops_.vz[i] = 0.0f;
+            drops_.y[i] = static_cast<float>(rng_.Range(-height_, height_));
+            drops_.vy[i] = rng_.Uniform(8.0f, 20.0f);
+            drops_.value[i] = static_cast<float>(rng_.Range(6, 18));
         }
     }
 
     void Update(float dt) override {
-        for (auto &col : columns_) {
-            col.y += col.speed * dt;
-            if (col.y - col.length > height_) {
-                col.y = static_cast<float>(GetRandomValue(-height_, 0));
-                col.speed = speedDist_(rng_);
-                col.length = lengthDist_(rng_);
+        drops_.Integrate(dt);
+        for (int i = 0; i < drops_.Size(); ++i) {
+            if (drops_.y[i] - drops_.value[i] > height_) {
+                drops_.y[i] = static_cast<float>(rng_.Range(-height_, 0));
+                drops_.vy[i] = rng_.Uniform(8.0f, 20.0f);
+                drops_.value[i] = static_cast<float>(rng_.Range(6, 18));
             }
         }
     }
 
-    void DrawFrame() override {
-        for (auto &col : columns_) {
-            for (int i = 0; i < col.length; ++i) {
-                int drawY = static_cast<int>(col.y) - i;
+    void DrawFrame(Canvas &canvas) override {
+        for (int d = 0; d < drops_.Size(); ++d) {
+            int x = static_cast<int>(drops_.x[d]);
+            int length = static_cast<int>(drops_.value[d]);
+            for (int i = 0; i < length; ++i) {
+                int drawY = static_cast<int>(drops_.y[d]) - i;
                 if (drawY < 0 || drawY >= height_) {
                     continue;
                 }
-                float intensity = 1.0f - (static_cast<float>(i) / static_cast<float>(col.length));
+                float intensity = 1.0f - (static_cast<float>(i) / static_cast<float>(length));
                 unsigned char g = static_cast<unsigned char>(std::clamp(intensity * 255.0f, 40.0f, 255.0f));
                 Color color = (i == 0) ? Color{180, 255, 180, 255} : Color{40, g, 40, 255};
-                DrawPixel(col.x, drawY, color);
-                if (col.x + 1 < width_) {
-                    DrawPixel(col.x + 1, drawY, Fade(color, 0.7f));
+                canvas.DrawPixel(x, drawY, color);
+                if (x + 1 < width_) {
+                    canvas.DrawPixel(x + 1, drawY, Fade(color, 0.7f));
                 }
             }
         }
     }
 
 private:
-    struct Column {
-        float y;
-        float speed;
-        int length;
-        int x;
-    };
-
-    std::vector<Column> columns_;
-    std::mt19937 rng_;
-    std::uniform_real_distribution<float> speedDist_{8.0f, 20.0f};
-    std::uniform_int_distribution<int> lengthDist_{6, 18};
+    ParticlePool drops_;
+    FastRandom rng_;
 };
 
 class StarfieldAnimation : public Animation {
 public:
     StarfieldAnimation(int width, int height)
-        : Animation(width, height), rng_(std::random_device{}()) {
+        : Animation(width, height), stars_(90), rng_(std::random_device{}()) {
         Reset();
     }
 
     const char *Name() const override { return "starfield"; }
 
+    // x and y are the direction from the viewer, z the depth
     void Reset() override {
-        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
-        std::uniform_real_distribution<float> depth(0.2f, 1.0f);
-        stars_.clear();
-        stars_.reserve(90);
-        for (int i = 0; i < 90; ++i) {
-            stars_.push_back({dist(rng_), dist(rng_), depth(rng_)});
-        }
+        stars_.Clear();
+        int first = stars_.Emit(stars_.Capacity());
+        int count = stars_.Size() - first;
+        rng_.Fill(stars_.x.data() + first, count, -1.0f, 1.0f);
+        rng_.Fill(stars_.y.data() + first, count, -1.0f, 1.0f);
+        rng_.Fill(stars_.z.data() + first, count, 0.2f, 1.0f);
+        std::fill(stars_.vx.begin() + first, stars_.vx.begin() + stars_.Size(), 0.0f);
+        std::fill(stars_.vy.begin() + first, stars_.vy.begin() + stars_.Size(), 0.0f);
+        std::fill(stars_.vz.begin() + first, stars_.vz.begin() + stars_.Size(), -0.35f);
     }
 
     void Update(float dt) override {
-        for (auto &star : stars_) {
-            star.z -= dt * 0.35f;
-            if (star.z <= 0.05f) {
-                RespawnStar(star);
+        stars_.Integrate(dt);
+        for (int i = 0; i < stars_.Size(); ++i) {
+            if (stars_.z[i] <= 0.05f) {
+                stars_.x[i] = rng_.Uniform(-1.0f, 1.0f);
+                stars_.y[i] = rng_.Uniform(-1.0f, 1.0f);
+                stars_.z[i] = rng_.Uniform(0.3f, 1.0f);
             }
         }
     }
 
-    void DrawFrame() override {
+    void DrawFrame(Canvas &canvas) override {
         float halfW = width_ / 2.0f;
         float halfH = height_ / 2.0f;
-        for (auto &star : stars_) {
-            float projX = (star.x / star.z) * halfW + halfW;
-            float projY = (star.y / star.z) * halfH + halfH;
+        for (int i = 0; i < stars_.Size(); ++i) {
+            float z = stars_.z[i];
+            float projX = (stars_.x[i] / z) * halfW + halfW;
+            float projY = (stars_.y[i] / z) * halfH + halfH;
             if (projX < 0 || projX >= width_ || projY < 0 || projY >= height_) {
                 continue;
             }
-            float brightness = std::clamp(1.0f - ((star.z - 0.05f) / 0.95f), 0.0f, 1.0f);
+            float brightness = std::clamp(1.0f - ((z - 0.05f) / 0.95f), 0.0f, 1.0f);
             unsigned char value = static_cast<unsigned char>(200.0f + 55.0f * brightness);
-            DrawPixel(static_cast<int>(projX), static_cast<int>(projY), Color{value, value, value, 255});
+            canvas.DrawPixel(static_cast<int>(projX), static_cast<int>(projY), Color{value, value, value, 255});
         }
     }
 
 private:
-    struct Star {
-        float x;
-        float y;
-        float z;
-    };
-
-    void RespawnStar(Star &star) {
-        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
-        std::uniform_real_distribution<float> depth(0.3f, 1.0f);
-        star.x = dist(rng_);
-        star.y = dist(rng_);
-        star.z = depth(rng_);
-    }
-
-    std::vector<Star> stars_;
-    std::mt19937 rng_;
+    ParticlePool stars_;
+    FastRandom rng_;
 };
 
 class SwirlAnimation : public Animation {
 public:
-    SwirlAnimation(int width, int height) : Animation(width, height) { Reset(); }
+    SwirlAnimation(int width, int height)
+        : Animation(width, height), geometry_(pixel_kernels::GeometryTable::For(width, height)),
+          hues_(width * height), row_(width) {
+        // The hue only depends on the angle around the center
+        for (size_t i = 0; i < hues_.size(); ++i) {
+            hues_[i] = std::fmod((geometry_.angle[i] / (2 * PI)) + 0.5f, 1.0f) * 360.0f;
+        }
+        Reset();
+    }
 
     const char *Name() const override { return "swirl"; }
 
@@ -187,89 +223,94 @@ public:
 
     void Update(float dt) override { time_ += dt * 0.9f; }
 
-    void DrawFrame() override {
-        float cx = (width_ - 1) / 2.0f;
-        float cy = (height_ - 1) / 2.0f;
+    // The wave turns 0.9 * 4 * kStep = 0.12 radians per step, so three turns take 157.08 steps;
+    // the seam is off by under one level per channel
+    int LoopSteps() const override { return 157; }
+
+    bool RendersPixels() const override { return true; }
+
+    void RenderTo(PixelSpan &pixels) override {
+        float phase = (time_ + SinceUpdate() * 0.9f) * 4.0f;
         for (int y = 0; y < height_; ++y) {
+            const float* distance = geometry_.distance.data() + y * width_;
+            const float* angle = geometry_.angle.data() + y * width_;
             for (int x = 0; x < width_; ++x) {
-                float dx = x - cx;
-                float dy = y - cy;
-                float dist = std::sqrt(dx * dx + dy * dy);
-                float angle = std::atan2(dy, dx);
-                float wave = std::sin(dist * 0.6f - time_ * 4.0f + angle * 2.0f);
+                float wave = pixel_kernels::FastSin(distance[x] * 0.6f - phase + angle[x] * 2.0f);
                 float brightness = std::clamp((wave + 1.0f) * 0.5f, 0.0f, 1.0f);
-                float hue = std::fmod((angle / (2 * PI)) + 0.5f, 1.0f);
-                Color color = ColorFromHSV(hue * 360.0f, 0.75f, 0.3f + 0.7f * brightness);
-                DrawPixel(x, y, color);
+                row_.value[x] = 0.3f + 0.7f * brightness;
             }
+            pixel_kernels::HsvToRgb(hues_.data() + y * width_, 0.75f, row_.value.data(), pixels.Row(y), width_);
         }
     }
 
 private:
+    const pixel_kernels::GeometryTable &geometry_;
+    // Hue per pixel, in degrees
+    std::vector<float> hues_;
+    pixel_kernels::HsvRow row_;
     float time_ = 0.0f;
 };
 
 class BouncingBallAnimation : public Animation {
 public:
     BouncingBallAnimation(int width, int height)
-        : Animation(width, height), rng_(std::random_device{}()) {
+        : Animation(width, height), balls_(5), rng_(std::random_device{}()) {
         Reset();
     }
 
     const char *Name() const override { return "bouncing_balls"; }
 
+    // value is the ball's hue
     void Reset() override {
-        std::uniform_real_distribution<float> px(4.0f, width_ - 4.0f);
-        std::uniform_real_distribution<float> py(4.0f, height_ - 4.0f);
-        std::uniform_real_distribution<float> vel(-24.0f, 24.0f);
-        balls_.clear();
-        balls_.reserve(5);
-        for (int i = 0; i < 5; ++i) {
-            Vector2 pos{px(rng_), py(rng_)};
-            Vector2 velv{vel(rng_), vel(rng_)};
-            Color color = ColorFromHSV((i * 60.0f), 0.9f, 1.0f);
-            balls_.push_back({pos, velv, color});
+        balls_.Clear();
+        int first = balls_.Emit(balls_.Capacity());
+        int count = balls_.Size() - first;
+        rng_.Fill(balls_.x.data() + first, count, 4.0f, width_ - 4.0f);
+        rng_.Fill(balls_.y.data() + first, count, 4.0f, height_ - 4.0f);
+        rng_.Fill(balls_.vx.data() + first, count, -24.0f, 24.0f);
+        rng_.Fill(balls_.vy.data() + first, count, -24.0f, 24.0f);
+        for (int i = first; i < balls_.Size(); ++i) {
+            balls_.previousX[i] = balls_.x[i];
+            balls_.previousY[i] = balls_.y[i];
+            balls_.vz[i] = 0.0f;
+            balls_.value[i] = i * 60.0f;
         }
     }
 
     void Update(float dt) override {
-        for (auto &ball : balls_) {
-            ball.pos.x += ball.vel.x * dt;
-            ball.pos.y += ball.vel.y * dt;
-            if (ball.pos.x < 2.0f) {
-                ball.pos.x = 2.0f;
-                ball.vel.x *= -1.0f;
+        balls_.Integrate(dt);
+        for (int i = 0; i < balls_.Size(); ++i) {
+            if (balls_.x[i] < 2.0f) {
+                balls_.x[i] = 2.0f;
+                balls_.vx[i] *= -1.0f;
             }
-            if (ball.pos.x > width_ - 3.0f) {
-                ball.pos.x = width_ - 3.0f;
-                ball.vel.x *= -1.0f;
+            if (balls_.x[i] > width_ - 3.0f) {
+                balls_.x[i] = width_ - 3.0f;
+                balls_.vx[i] *= -1.0f;
             }
-            if (ball.pos.y < 2.0f) {
-                ball.pos.y = 2.0f;
-                ball.vel.y *= -1.0f;
+            if (balls_.y[i] < 2.0f) {
+                balls_.y[i] = 2.0f;
+                balls_.vy[i] *= -1.0f;
             }
-            if (ball.pos.y > height_ - 3.0f) {
-                ball.pos.y = height_ - 3.0f;
-                ball.vel.y *= -1.0f;
+            if (balls_.y[i] > height_ - 3.0f) {
+                balls_.y[i] = height_ - 3.0f;
+                balls_.vy[i] *= -1.0f;
             }
         }
     }
 
-    void DrawFrame() override {
-        for (auto &ball : balls_) {
-            DrawCircleV(ball.pos, 2.5f, ball.color);
+    void DrawFrame(Canvas &canvas) override {
+        // Between the last two steps; walls are where the balls turn, so this never crosses one
+        for (int i = 0; i < balls_.Size(); ++i) {
+            Vector2 center{balls_.previousX[i] + (balls_.x[i] - balls_.previousX[i]) * stepFraction_,
+                           balls_.previousY[i] + (balls_.y[i] - balls_.previousY[i]) * stepFraction_};
+            canvas.DrawCircle(center, 2.5f, ColorFromHSV(balls_.value[i], 0.9f, 1.0f));
         }
     }
 
 private:
-    struct Ball {
-        Vector2 pos;
-        Vector2 vel;
-        Color color;
-    };
-
-    std::vector<Ball> balls_;
-    std::mt19937 rng_;
+    ParticlePool balls_;
+    FastRandom rng_;
 };
 
 class WaveLinesAnimation : public Animation {
@@ -282,18 +323,19 @@ public:
 
     void Update(float dt) override { time_ += dt; }
 
-    void DrawFrame() override {
+    void DrawFrame(Canvas &canvas) override {
+        float time = time_ + SinceUpdate();
         for (int x = 0; x < width_; ++x) {
-            float base = std::sin(time_ * 2.0f + x * 0.25f);
-            float offset = std::cos(time_ + x * 0.13f) * 4.0f;
+            float base = pixel_kernels::FastSin(time * 2.0f + x * 0.25f);
+            float offset = pixel_kernels::FastCos(time + x * 0.13f) * 4.0f;
             float centerY = (height_ / 2.0f) + offset;
-            Color color = ColorFromHSV(std::fmod((time_ * 40.0f + x * 2.5f), 360.0f), 0.8f, 0.9f);
+            Color color = ColorFromHSV(std::fmod((time * 40.0f + x * 2.5f), 360.0f), 0.8f, 0.9f);
             int y = static_cast<int>(centerY + base * (height_ / 3.0f));
             for (int dy = -2; dy <= 2; ++dy) {
                 int drawY = y + dy;
                 if (drawY >= 0 && drawY < height_) {
                     float fade = 1.0f - (std::abs(dy) / 3.0f);
-                    DrawPixel(x, drawY, Fade(color, std::clamp(fade, 0.1f, 1.0f)));
+                    canvas.DrawPixel(x, drawY, Fade(color, std::clamp(fade, 0.1f, 1.0f)));
                 }
             }
         }
@@ -305,53 +347,62 @@ private:
 
 class SparkleAnimation : public Animation {
 public:
+    // At 8 sparks per step, each fading by 3.5 * kStep a step, about 360 are lit at once
     SparkleAnimation(int width, int height)
-        : Animation(width, height), rng_(std::random_device{}()),
-          distribution_(0, width * height - 1) {
+        : Animation(width, height), sparks_(512), rng_(std::random_device{}()) {
         Reset();
     }
 
     const char *Name() const override { return "sparkle"; }
 
     void Reset() override {
-        brightness_.assign(width_ * height_, 0.0f);
+        sparks_.Clear();
     }
 
+    // value is the brightness; a spark is dropped once it would draw black
     void Update(float dt) override {
-        for (float &b : brightness_) {
-            b *= (1.0f - dt * 3.5f);
-            if (b < 0.0f) {
-                b = 0.0f;
-            }
-        }
-        for (int i = 0; i < 8; ++i) {
-            int idx = distribution_(rng_);
-            brightness_[idx] = 1.0f;
+        float fade = std::max(1.0f - dt * 3.5f, 0.0f);
+        for (int i = 0; i < sparks_.Size(); ++i) {
+            sparks_.value[i] *= fade;
         }
+        sparks_.RemoveIf([this](int i) { return sparks_.value[i] < 1.0f / 255.0f; });
+
+        int first = sparks_.Emit(8);
+        int count = sparks_.Size() - first;
+        rng_.Fill(sparks_.x.data() + first, count, 0.0f, (float)width_);
+        rng_.Fill(sparks_.y.data() + first, count, 0.0f, (float)height_);
+        std::fill(sparks_.value.begin() + first, sparks_.value.begin() + sparks_.Size(), 1.0f);
     }
 
-    void DrawFrame() override {
+    bool RendersPixels() const override { return true; }
+
+    void RenderTo(PixelSpan &pixels) override {
         for (int y = 0; y < height_; ++y) {
-            for (int x = 0; x < width_; ++x) {
-                float value = brightness_[y * width_ + x];
-                Color color = ColorFromHSV(60.0f, 0.2f, std::clamp(value, 0.0f, 1.0f));
-                if (value > 0.8f) {
-                    color = Color{255, 255, 200, 255};
-                }
-                DrawPixel(x, y, color);
+            std::fill(pixels.Row(y), pixels.Row(y) + width_, BLACK);
+        }
+        for (int i = 0; i < sparks_.Size(); ++i) {
+            float value = sparks_.value[i];
+            Color color = (value > 0.8f) ? Color{255, 255, 200, 255}
+                                         : pixel_kernels::HsvToRgb(60.0f, 0.2f, value);
+            // Where sparks overlap the brightest wins; red rises with brightness in both colors
+            int x = std::min((int)sparks_.x[i], width_ - 1);
+            int y = std::min((int)sparks_.y[i], height_ - 1);
+            Color &pixel = pixels.At(x, y);
+            if (color.r >= pixel.r) {
+                pixel = color;
             }
         }
     }
 
 private:
-    std::vector<float> brightness_;
-    std::mt19937 rng_;
-    std::uniform_int_distribution<int> distribution_;
+    ParticlePool sparks_;
+    FastRandom rng_;
 };
 
 class FireAnimation : public Animation {
 public:
-    FireAnimation(int width, int height) : Animation(width, height), rng_(std::random_device{}()) {
+    FireAnimation(int width, int height)
+        : Animation(width, height), rng_(std::random_device{}()), row_(width) {
         Reset();
     }
 
@@ -361,6 +412,7 @@ public:
         buffer_.assign(width_ * height_, 0);
     }
 
+    // One cellular automaton step per call; the fixed step rate is what sets how fast it burns
     void Update(float dt) override {
         (void)dt;
         std::uniform_int_distribution<int> bottom(160, 255);
@@ -383,31 +435,40 @@ public:
         }
     }
 
-    void DrawFrame() override {
+    bool RendersPixels() const override { return true; }
+
+    void RenderTo(PixelSpan &pixels) override {
         for (int y = 0; y < height_; ++y) {
             for (int x = 0; x < width_; ++x) {
                 int value = buffer_[y * width_ + x];
-                float hue = 20.0f + (value / 255.0f) * 40.0f;
-                float brightness = std::clamp(value / 255.0f, 0.0f, 1.0f);
-                Color color = ColorFromHSV(hue, 1.0f, std::max(0.2f, brightness));
-                DrawPixel(x, y, color);
+                row_.hue[x] = 20.0f + (value / 255.0f) * 40.0f;
+                row_.value[x] = std::max(0.2f, std::clamp(value / 255.0f, 0.0f, 1.0f));
             }
+            row_.ConvertTo(pixels.Row(y), 1.0f);
         }
     }
 
 private:
     std::vector<int> buffer_;
     std::mt19937 rng_;
+    pixel_kernels::HsvRow row_;
 };
 
 class PulseSquaresAnimation : public Animation {
 public:
-    PulseSquaresAnimation(int width, int height) : Animation(width, height) { Reset(); }
+    PulseSquaresAnimation(int width, int height)
+        : Animation(width, height), geometry_(pixel_kernels::GeometryTable::For(width, height)),
+          row_(width) {
+        Reset();
+    }
 
     const char *Name() const override { return "pulse_squares"; }
 
     void Reset() override {
         pulses_.clear();
+        // A new pulse starts every sixth of the size and lasts until it has crossed the whole
+        // matrix, so no more than seven are alive at once
+        pulses_.reserve(8);
         time_ = 0.0f;
     }
 
@@ -424,12 +485,13 @@ public:
         }
     }
 
-    void DrawFrame() override {
-        float cx = (width_ - 1) / 2.0f;
-        float cy = (height_ - 1) / 2.0f;
+    bool RendersPixels() const override { return true; }
+
+    void RenderTo(PixelSpan &pixels) override {
         for (int y = 0; y < height_; ++y) {
+            const float* ringDistance = geometry_.ringDistance.data() + y * width_;
             for (int x = 0; x < width_; ++x) {
-                float dist = std::max(std::abs(x - cx), std::abs(y - cy));
+                float dist = ringDistance[x];
                 float brightness = 0.0f;
                 for (auto &pulse : pulses_) {
                     float diff = std::fabs(dist - pulse.radius);
@@ -437,9 +499,10 @@ public:
                         brightness = std::max(brightness, 1.0f - (diff / 2.5f));
                     }
                 }
-                Color color = ColorFromHSV(std::fmod((time_ * 60.0f + dist * 10.0f), 360.0f), 0.7f, 0.2f + 0.8f * brightness);
-                DrawPixel(x, y, color);
+                row_.hue[x] = std::fmod((time_ * 60.0f + dist * 10.0f), 360.0f);
+                row_.value[x] = 0.2f + 0.8f * brightness;
             }
+            row_.ConvertTo(pixels.Row(y), 0.7f);
         }
     }
 
@@ -449,7 +512,9 @@ private:
         float speed;
     };
 
+    const pixel_kernels::GeometryTable &geometry_;
     std::vector<Pulse> pulses_;
+    pixel_kernels::HsvRow row_;
     float time_ = 0.0f;
 };
 
@@ -463,21 +528,24 @@ public:
     const char *Name() const override { return "scrolling_text"; }
 
     void Reset() override {
-        textWidth_ = MeasureText(message_.c_str(), fontSize_);
         offset_ = static_cast<float>(width_);
     }
 
     void Update(float dt) override {
         offset_ -= dt * 24.0f;
-        if (offset_ < -textWidth_) {
+        // The width is only known once the text has been measured by the first DrawFrame()
+        if (textWidth_ > 0 && offset_ < -textWidth_) {
             offset_ = static_cast<float>(width_);
         }
     }
 
-    void DrawFrame() override {
+    void DrawFrame(Canvas &canvas) override {
+        if (textWidth_ == 0) {
+            textWidth_ = canvas.MeasureText(message_.c_str(), fontSize_);
+        }
         int y = height_ / 2 - fontSize_ / 2;
-        DrawText(message_.c_str(), static_cast<int>(offset_), y, fontSize_, WHITE);
-        DrawText(message_.c_str(), static_cast<int>(offset_) + textWidth_ + 4, y, fontSize_, WHITE);
+        canvas.DrawText(message_.c_str(), static_cast<int>(offset_), y, fontSize_, WHITE);
+        canvas.DrawText(message_.c_str(), static_cast<int>(offset_) + textWidth_ + 4, y, fontSize_, WHITE);
     }
 
 private:
@@ -0,0 +1,90 @@
+#include "animations/clip_cache.h"
+
+#include <algorithm>
+#include <iostream>
+
+ClipCache::ClipCache(int width, int height, size_t budgetBytes)
+    : width_(width), height_(height), budgetBytes_(budgetBytes) {
+    if (budgetBytes_ > 0) {
+        worker_ = std::thread([this]() { Run(); });
+    }
+}
+
+ClipCache::~ClipCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ClipCache::Prepare(size_t key, const std::string &name, Factory create, int frames) {
+    if (budgetBytes_ == 0 || frames <= 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto sameKey = [key](const auto &entry) { return entry.key == key; };
+        if (std::any_of(clips_.begin(), clips_.end(), sameKey) ||
+            std::any_of(jobs_.begin(), jobs_.end(), sameKey) ||
+            std::find(recording_.begin(), recording_.end(), key) != recording_.end()) {
+            return;
+        }
+        jobs_.push_back({key, name, std::move(create), frames});
+    }
+    wake_.notify_one();
+}
+
+std::shared_ptr<const AnimationClip> ClipCache::Find(size_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Cached &cached : clips_) {
+        if (cached.key == key) {
+            cached.lastUsed = ++useClock_;
+            return cached.clip;
+        }
+    }
+    return nullptr;
+}
+
+void ClipCache::Run() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            recording_.push_back(job.key);
+        }
+
+        std::unique_ptr<Animation> animation = job.create();
+        std::shared_ptr<const AnimationClip> clip = AnimationClip::Record(*animation, width_, height_, job.frames);
+        size_t bytes = clip->Bytes();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        recording_.erase(std::find(recording_.begin(), recording_.end(), job.key));
+        if (bytes > budgetBytes_) {
+            std::cout << "Clip " << job.name << " needs " << bytes / 1024 << " KB, over the "
+                      << budgetBytes_ / 1024 << " KB clip budget; it will be simulated" << std::endl;
+            continue;
+        }
+        // Make room by dropping the least recently played clips
+        while (bytes_ + bytes > budgetBytes_) {
+            auto oldest = std::min_element(clips_.begin(), clips_.end(), [](const Cached &a, const Cached &b) {
+                return a.lastUsed < b.lastUsed;
+            });
+            bytes_ -= oldest->clip->Bytes();
+            clips_.erase(oldest);
+        }
+        clips_.push_back({job.key, clip, ++useClock_});
+        bytes_ += bytes;
+        std::cout << "Recorded clip " << job.name << ": " << clip->FrameCount() << " frames, "
+                  << bytes / 1024 << " KB" << std::endl;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "animations/animation_clip.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Clips of the looping animations, recorded on a background thread from a fresh instance of
+// each, so recording never touches the instance the render thread is drawing. The cache keeps
+// within a memory budget by evicting the clip played least recently; an evicted clip is recorded
+// again the next time it is prepared. Clips are shared, so one being played survives eviction.
+class ClipCache {
+public:
+    using Factory = std::function<std::unique_ptr<Animation>()>;
+
+    // A budget of 0 disables the cache: nothing is recorded and Find() always misses
+    ClipCache(int width, int height, size_t budgetBytes);
+    ~ClipCache();
+
+    ClipCache(const ClipCache &) = delete;
+    ClipCache &operator=(const ClipCache &) = delete;
+
+    // Any thread. Queues a recording of `frames` steps unless `key` is cached or queued already.
+    void Prepare(size_t key, const std::string &name, Factory create, int frames);
+    // Any thread. The clip if it is recorded, which also marks it as just played; nullptr if not.
+    std::shared_ptr<const AnimationClip> Find(size_t key);
+
+private:
+    struct Job {
+        size_t key;
+        std::string name;
+        Factory create;
+        int frames;
+    };
+
+    struct Cached {
+        size_t key;
+        std::shared_ptr<const AnimationClip> clip;
+        uint64_t lastUsed;
+    };
+
+    void Run();
+
+    int width_;
+    int height_;
+    size_t budgetBytes_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> jobs_;
+    // Key being recorded right now, so Prepare() does not queue it twice
+    std::vector<size_t> recording_;
+    std::vector<Cached> clips_;
+    size_t bytes_ = 0;
+    uint64_t useClock_ = 0;
+    bool stopping_ = false;
+    std::thread worker_;
+};
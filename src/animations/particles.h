@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Counter-based random numbers: value i is a hash of (seed, i), so there is no state to carry
+// from one value to the next and a loop filling an array vectorizes. Seedable, so a sequence can
+// be replayed; not for anything cryptographic.
+class FastRandom {
+public:
+    explicit FastRandom(uint32_t seed) : seed_(seed) {}
+
+    uint32_t Next() {
+        return Mix(seed_ + (counter_++) * 0x9E3779B9u);
+    }
+
+    // In [0, 1)
+    float Uniform() {
+        return ToUnit(Next());
+    }
+
+    float Uniform(float low, float high) {
+        return low + (high - low) * Uniform();
+    }
+
+    // In [low, high], both inclusive
+    int Range(int low, int high) {
+        return low + (int)(Uniform() * (float)(high - low + 1));
+    }
+
+    // `count` values in [low, high), the same ones as that many calls to Uniform(low, high)
+    void Fill(float* out, int count, float low, float high) {
+        uint32_t base = counter_;
+        for (int i = 0; i < count; ++i) {
+            out[i] = low + (high - low) * ToUnit(Mix(seed_ + (base + (uint32_t)i) * 0x9E3779B9u));
+        }
+        counter_ += (uint32_t)count;
+    }
+
+private:
+    // lowbias32 (Chris Wellons' hash-prospector): a cheap 32-bit mix with good avalanche
+    static uint32_t Mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    static float ToUnit(uint32_t bits) {
+        return (float)(bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint32_t seed_;
+    uint32_t counter_ = 0;
+};
+
+// Particles as a structure of arrays in a pool sized once up front, so the per-step passes are
+// plain loops over float arrays (which the compiler vectorizes) and nothing allocates after
+// construction. Every array is Capacity() long; only the first Size() entries are live. Removal
+// moves the last particle into the hole, so indices are not stable across RemoveIf().
+class ParticlePool {
+public:
+    explicit ParticlePool(int capacity)
+        : x(capacity, 0.0f), y(capacity, 0.0f), z(capacity, 0.0f),
+          vx(capacity, 0.0f), vy(capacity, 0.0f), vz(capacity, 0.0f),
+          previousX(capacity, 0.0f), previousY(capacity, 0.0f), value(capacity, 0.0f),
+          capacity_(capacity) {}
+
+    int Size() const { return size_; }
+    int Capacity() const { return capacity_; }
+
+    void Clear() { size_ = 0; }
+
+    // Makes room for up to `count` more particles, fewer if the pool fills up, and returns the
+    // index of the first. The new ones [first, Size()) hold stale values; the caller sets every
+    // channel it uses.
+    int Emit(int count) {
+        int first = size_;
+        size_ = std::min(size_ + std::max(count, 0), capacity_);
+        return first;
+    }
+
+    // Moves every particle along its velocity, remembering where it was for interpolation
+    void Integrate(float dt) {
+        for (int i = 0; i < size_; ++i) {
+            previousX[i] = x[i];
+            previousY[i] = y[i];
+        }
+        for (int i = 0; i < size_; ++i) {
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            z[i] += vz[i] * dt;
+        }
+    }
+
+    // Removes the particles for which `dead(index)` is true
+    template <typename Predicate>
+    void RemoveIf(Predicate dead) {
+        int i = 0;
+        while (i < size_) {
+            if (dead(i)) {
+                Move(size_ - 1, i);
+                --size_;
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Position, velocity and position before the last Integrate()
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> vz;
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+    // Meaning is up to the owner: brightness, trail length, hue...
+    std::vector<float> value;
+
+private:
+    void Move(int from, int to) {
+        x[to] = x[from];
+        y[to] = y[from];
+        z[to] = z[from];
+        vx[to] = vx[from];
+        vy[to] = vy[from];
+        vz[to] = vz[from];
+        previousX[to] = previousX[from];
+        previousY[to] = previousY[from];
+        value[to] = value[from];
+    }
+
+    int capacity_;
+    int size_ = 0;
+};
@@ -0,0 +1,138 @@
+#include "animations/pixel_kernels.h"
+
+#include <memory>
+#include <mutex>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pixel_kernels {
+
+const GeometryTable &GeometryTable::For(int width, int height) {
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<GeometryTable>> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &table : tables) {
+        if (table->width == width && table->height == height) {
+            return *table;
+        }
+    }
+
+    auto table = std::make_unique<GeometryTable>();
+    table->width = width;
+    table->height = height;
+    table->distance.resize(width * height);
+    table->angle.resize(width * height);
+    table->ringDistance.resize(width * height);
+    float cx = (width - 1) / 2.0f;
+    float cy = (height - 1) / 2.0f;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float dx = x - cx;
+            float dy = y - cy;
+            table->distance[y * width + x] = std::sqrt(dx * dx + dy * dy);
+            table->angle[y * width + x] = std::atan2(dy, dx);
+            table->ringDistance[y * width + x] = std::max(std::fabs(dx), std::fabs(dy));
+        }
+    }
+    tables.push_back(std::move(table));
+    return *tables.back();
+}
+
+namespace {
+
+// Four pixels per step. Each channel follows the scalar HsvToRgb(): k = (n + hue / 60) mod 6,
+// folded to min(k, 4 - k) and clamped to 0..1, then value - value * saturation * k.
+#if defined(__ARM_NEON)
+
+float32x4_t floor4(float32x4_t x) {
+    float32x4_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(x));
+    // Truncation rounds negative values up; take one off where it did
+    uint32x4_t roundedUp = vcgtq_f32(truncated, x);
+    return vsubq_f32(truncated, vreinterpretq_f32_u32(vandq_u32(roundedUp, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+}
+
+uint32x4_t channel4(float32x4_t sector, float n, float32x4_t value, float32x4_t valueSaturation) {
+    float32x4_t x = vaddq_f32(sector, vdupq_n_f32(n));
+    float32x4_t k = vsubq_f32(x, vmulq_f32(vdupq_n_f32(6.0f), floor4(vmulq_f32(x, vdupq_n_f32(1.0f / 6.0f)))));
+    k = vminq_f32(k, vsubq_f32(vdupq_n_f32(4.0f), k));
+    k = vmaxq_f32(vminq_f32(k, vdupq_n_f32(1.0f)), vdupq_n_f32(0.0f));
+    float32x4_t level = vmulq_f32(vsubq_f32(value, vmulq_f32(valueSaturation, k)), vdupq_n_f32(255.0f));
+    return vcvtq_u32_f32(vmaxq_f32(level, vdupq_n_f32(0.0f)));
+}
+
+int convert4(const float* hue, float saturation, const float* value, Color* out, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // 32-bit ARM has no vector divide; the reciprocal can move a hue by an ulp, which is
+        // invisible
+        float32x4_t sector = vmulq_f32(vld1q_f32(hue + i), vdupq_n_f32(1.0f / 60.0f));
+        float32x4_t v = vld1q_f32(value + i);
+        float32x4_t vs = vmulq_f32(v, vdupq_n_f32(saturation));
+        uint32x4_t r = channel4(sector, 5.0f, v, vs);
+        uint32x4_t g = channel4(sector, 3.0f, v, vs);
+        uint32x4_t b = channel4(sector, 1.0f, v, vs);
+        // Color is r, g, b, a in memory: little-endian 0xAABBGGRR
+        uint32x4_t rgba = vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 8)),
+                                    vorrq_u32(vshlq_n_u32(b, 16), vdupq_n_u32(0xFF000000u)));
+        vst1q_u32((uint32_t*)(out + i), rgba);
+    }
+    return i;
+}
+
+#elif defined(__SSE2__)
+
+__m128 floor4(__m128 x) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    // Truncation rounds negative values up; take one off where it did
+    __m128 roundedUp = _mm_cmpgt_ps(truncated, x);
+    return _mm_sub_ps(truncated, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+}
+
+__m128i channel4(__m128 sector, float n, __m128 value, __m128 valueSaturation) {
+    __m128 x = _mm_add_ps(sector, _mm_set1_ps(n));
+    __m128 k = _mm_sub_ps(x, _mm_mul_ps(_mm_set1_ps(6.0f), floor4(_mm_div_ps(x, _mm_set1_ps(6.0f)))));
+    k = _mm_min_ps(k, _mm_sub_ps(_mm_set1_ps(4.0f), k));
+    k = _mm_max_ps(_mm_min_ps(k, _mm_set1_ps(1.0f)), _mm_setzero_ps());
+    __m128 level = _mm_mul_ps(_mm_sub_ps(value, _mm_mul_ps(valueSaturation, k)), _mm_set1_ps(255.0f));
+    return _mm_cvttps_epi32(_mm_max_ps(level, _mm_setzero_ps()));
+}
+
+int convert4(const float* hue, float saturation, const float* value, Color* out, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 sector = _mm_div_ps(_mm_loadu_ps(hue + i), _mm_set1_ps(60.0f));
+        __m128 v = _mm_loadu_ps(value + i);
+        __m128 vs = _mm_mul_ps(v, _mm_set1_ps(saturation));
+        __m128i r = channel4(sector, 5.0f, v, vs);
+        __m128i g = channel4(sector, 3.0f, v, vs);
+        __m128i b = channel4(sector, 1.0f, v, vs);
+        // Color is r, g, b, a in memory: little-endian 0xAABBGGRR
+        __m128i rgba = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                    _mm_or_si128(_mm_slli_epi32(b, 16), _mm_set1_epi32((int)0xFF000000u)));
+        _mm_storeu_si128((__m128i*)(out + i), rgba);
+    }
+    return i;
+}
+
+#else
+
+int convert4(const float*, float, const float*, Color*, int) {
+    return 0;
+}
+
+#endif
+
+}  // namespace
+
+void HsvToRgb(const float* hue, float saturation, const float* value, Color* out, int count) {
+    int i = convert4(hue, saturation, value, out, count);
+    for (; i < count; ++i) {
+        out[i] = HsvToRgb(hue[i], saturation, value[i]);
+    }
+}
+
+}  // namespace pixel_kernels
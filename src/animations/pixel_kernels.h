@@ -0,0 +1,82 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Shared math for the procedural animations, which compute every pixel of every frame. Hue to
+// RGB conversion runs four pixels at a time with NEON (the Pi) or SSE2 (desktop) and falls back
+// to scalar code elsewhere; per-pixel geometry that only depends on the matrix size is tabulated
+// once.
+namespace pixel_kernels {
+
+const float kTwoPi = 6.28318530717958647692f;
+
+// Per-pixel geometry relative to the center of a width x height matrix, row-major
+struct GeometryTable {
+    int width = 0;
+    int height = 0;
+    // Euclidean distance from the center
+    std::vector<float> distance;
+    // atan2(dy, dx), in -pi..pi
+    std::vector<float> angle;
+    // max(|dx|, |dy|): the distance in square rings
+    std::vector<float> ringDistance;
+
+    // Built on first use and kept for the life of the process. Thread safe, as clips are
+    // recorded from animations created on a background thread.
+    static const GeometryTable &For(int width, int height);
+};
+
+// Same result as raylib's ColorFromHSV() for hues of 0 and up: hue in degrees, saturation and
+// value in 0..1, opaque. Negative hues wrap around the color wheel (-60 is 300), which raylib's
+// fmod() does not do; the vector path in HsvToRgb() below wraps the same way.
+inline Color HsvToRgb(float hue, float saturation, float value) {
+    Color color = {0, 0, 0, 255};
+    unsigned char* channels[3] = {&color.r, &color.g, &color.b};
+    const float sectors[3] = {5.0f, 3.0f, 1.0f};
+    for (int c = 0; c < 3; c++) {
+        float x = sectors[c] + hue / 60.0f;
+        float k = x - 6.0f * std::floor(x / 6.0f);
+        k = std::min(k, 4.0f - k);
+        k = std::max(std::min(k, 1.0f), 0.0f);
+        *channels[c] = (unsigned char)((value - value * saturation * k) * 255.0f);
+    }
+    return color;
+}
+
+// HsvToRgb() over `count` pixels sharing one saturation
+void HsvToRgb(const float* hue, float saturation, const float* value, Color* out, int count);
+
+// Scratch space for one row of hue (degrees) and value (0..1) per pixel, so an animation can
+// fill a row with scalar math and convert it in one HsvToRgb() call
+struct HsvRow {
+    std::vector<float> hue;
+    std::vector<float> value;
+
+    explicit HsvRow(int width) : hue(width, 0.0f), value(width, 0.0f) {}
+
+    void ConvertTo(Color* out, float saturation) const {
+        HsvToRgb(hue.data(), saturation, value.data(), out, (int)hue.size());
+    }
+};
+
+// Parabolic sine approximation, good to about 0.001 over any range: plenty for brightness waves,
+// and branch free, so loops over it vectorize
+inline float FastSin(float x) {
+    // Wrap to -pi..pi
+    x -= kTwoPi * std::floor(x * (1.0f / kTwoPi) + 0.5f);
+    const float b = 4.0f / (kTwoPi / 2.0f);
+    const float c = -4.0f / ((kTwoPi / 2.0f) * (kTwoPi / 2.0f));
+    float y = b * x + c * x * std::fabs(x);
+    // One refinement step takes the error from ~0.06 to ~0.001
+    return 0.225f * (y * std::fabs(y) - y) + y;
+}
+
+inline float FastCos(float x) {
+    return FastSin(x + kTwoPi / 4.0f);
+}
+
+}  // namespace pixel_kernels
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free bounded multi-producer/single-consumer queue (Dmitry Vyukov's sequenced ring). Each
+// cell carries a sequence number that says whose turn it is: producers claim a position with one
+// compare-exchange on the tail and publish the value by bumping the cell's sequence, and the
+// consumer frees the cell the same way. A full queue refuses new values instead of blocking or
+// overwriting, so producers can report the rejection.
+template <typename T, size_t Capacity>
+class BoundedMpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    BoundedMpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue &) = delete;
+    BoundedMpscQueue &operator=(const BoundedMpscQueue &) = delete;
+
+    // Any thread. Returns false if the queue is full.
+    bool TryPush(const T &value) {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[position & (Capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                // The cell is free for this position; claim it unless another producer got there first
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The consumer has not freed this cell from the previous lap
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only. Returns false if nothing is ready, which includes a value whose
+    // producer has claimed its cell but not finished writing it.
+    bool TryPop(T &value) {
+        Cell &cell = cells_[head_ & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Cell cells_[Capacity];
+    // Producers and the consumer each write their own end; keep them off one cache line
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) size_t head_ = 0;
+};
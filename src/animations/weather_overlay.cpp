@@ -0,0 +1,138 @@
+#include "animations/weather_overlay.h"
+
+#include "animations/animations.h"
+
+#include <cmath>
+
+namespace {
+
+// Same cap on catching up as AnimationManager: half a second
+const int kMaxStepsPerUpdate = 15;
+
+// Particles per second, and how long the slowest particle takes to cross the matrix
+const float kRainRate = 40.0f;
+const float kRainFillSeconds = 1.0f;
+const float kSnowRate = 14.0f;
+const float kSnowFillSeconds = 9.0f;
+
+const Color kRainColor = {120, 150, 255, 140};
+const Color kSnowColor = {235, 240, 255, 200};
+
+}  // namespace
+
+WeatherOverlay::WeatherOverlay(int width, int height, uint32_t seed)
+    : width_(width), height_(height), particles_(kCapacity), random_(seed) {}
+
+void WeatherOverlay::SetWeather(WeatherType type) {
+    Kind kind = Kind::None;
+    if (type == WeatherType::cloudy_rain || type == WeatherType::cloudy_thunder) {
+        kind = Kind::Rain;
+    } else if (type == WeatherType::cloudy_snow) {
+        kind = Kind::Snow;
+    }
+    if (kind == kind_) {
+        return;
+    }
+    kind_ = kind;
+    particles_.Clear();
+    accumulator_ = 0.0f;
+    emitCredit_ = 0.0f;
+    ignoreNextDt_ = true;
+    if (kind_ != Kind::None) {
+        float fillSeconds = (kind_ == Kind::Rain) ? kRainFillSeconds : kSnowFillSeconds;
+        for (int i = 0; i < (int)(fillSeconds / Animation::kStep); ++i) {
+            Step();
+        }
+    }
+}
+
+bool WeatherOverlay::IsActive() const {
+    return kind_ != Kind::None;
+}
+
+void WeatherOverlay::Update(float dt) {
+    if (kind_ == Kind::None) {
+        return;
+    }
+    if (ignoreNextDt_) {
+        dt = 0.0f;
+        ignoreNextDt_ = false;
+    }
+    accumulator_ += dt;
+    int steps = 0;
+    while (accumulator_ >= Animation::kStep && steps < kMaxStepsPerUpdate) {
+        Step();
+        accumulator_ -= Animation::kStep;
+        ++steps;
+    }
+    if (accumulator_ >= Animation::kStep) {
+        accumulator_ = std::fmod(accumulator_, Animation::kStep);
+    }
+}
+
+void WeatherOverlay::Step() {
+    particles_.Integrate(Animation::kStep);
+    // Rain streaks trail 3 pixels behind their head
+    float bottom = (kind_ == Kind::Rain) ? height_ + 3.0f : (float)height_;
+    float right = width_ + 2.0f;
+    particles_.RemoveIf([&](int i) { return particles_.y[i] > bottom || particles_.x[i] > right; });
+
+    emitCredit_ += ((kind_ == Kind::Rain) ? kRainRate : kSnowRate) * Animation::kStep;
+    int count = (int)emitCredit_;
+    emitCredit_ -= count;
+    Emit(count);
+}
+
+void WeatherOverlay::Emit(int count) {
+    int first = particles_.Emit(count);
+    int emitted = particles_.Size() - first;
+    if (emitted == 0) {
+        return;
+    }
+    float* x = particles_.x.data() + first;
+    float* y = particles_.y.data() + first;
+    float* z = particles_.z.data() + first;
+    float* vx = particles_.vx.data() + first;
+    float* vy = particles_.vy.data() + first;
+    float* vz = particles_.vz.data() + first;
+    float* value = particles_.value.data() + first;
+    if (kind_ == Kind::Rain) {
+        // Slanted by a light wind, so drops start up to 8 pixels left of the matrix
+        random_.Fill(x, emitted, -8.0f, (float)width_);
+        random_.Fill(y, emitted, -4.0f, 0.0f);
+        random_.Fill(vx, emitted, 5.0f, 8.0f);
+        random_.Fill(vy, emitted, 38.0f, 52.0f);
+        std::fill(z, z + emitted, 0.0f);
+        std::fill(vz, vz + emitted, 0.0f);
+        std::fill(value, value + emitted, 0.0f);
+    } else {
+        // Flakes sway around x: z is the sway phase, vz its rate and value its amplitude
+        random_.Fill(x, emitted, 0.0f, (float)width_);
+        random_.Fill(y, emitted, -2.0f, 0.0f);
+        std::fill(vx, vx + emitted, 0.0f);
+        random_.Fill(vy, emitted, 4.0f, 8.0f);
+        random_.Fill(z, emitted, 0.0f, pixel_kernels::kTwoPi);
+        random_.Fill(vz, emitted, 1.5f, 2.5f);
+        random_.Fill(value, emitted, 0.5f, 1.5f);
+    }
+    std::copy(x, x + emitted, particles_.previousX.data() + first);
+    std::copy(y, y + emitted, particles_.previousY.data() + first);
+}
+
+void WeatherOverlay::Draw(Canvas &canvas) {
+    if (kind_ == Kind::Rain) {
+        // A fixed-length streak along the fall reads as rain even at 5 FPS, where a drop moves
+        // about 9 pixels between frames
+        for (int i = 0; i < particles_.Size(); ++i) {
+            float slope = particles_.vx[i] / particles_.vy[i];
+            int headX = (int)std::floor(particles_.x[i]);
+            int headY = (int)std::floor(particles_.y[i]);
+            canvas.DrawLine((int)std::floor(particles_.x[i] - slope * 3.0f), headY - 3, headX, headY, kRainColor);
+        }
+    } else if (kind_ == Kind::Snow) {
+        for (int i = 0; i < particles_.Size(); ++i) {
+            float x = particles_.x[i] + pixel_kernels::FastSin(particles_.z[i]) * particles_.value[i];
+            canvas.DrawPixel((int)std::floor(x), (int)std::floor(particles_.y[i]), kSnowColor);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "animations/particles.h"
+#include "render/canvas.h"
+#include "weather/forecast.h"
+
+#include <cstdint>
+
+// Rain or snow falling over the clock face while the forecast calls for it. Particles are stepped
+// at Animation::kStep like the full screen animations, so the overlay looks the same at the
+// panel's 5 FPS as in the shim; at that rate a frame costs one integrate pass over at most
+// kCapacity particles and a line or pixel per particle.
+class WeatherOverlay {
+public:
+    WeatherOverlay(int width, int height, uint32_t seed);
+
+    // Rain for rain and thunderstorms, snow for snow, nothing otherwise. Switching fills the sky
+    // straight away rather than starting from an empty one.
+    void SetWeather(WeatherType type);
+    bool IsActive() const;
+
+    // Advances by the wall time since the last call, in fixed steps. The first call after rain or
+    // snow starts does not advance: its frame time runs from a frame drawn before, possibly before
+    // an idle sleep.
+    void Update(float dt);
+    // Draws on top of whatever is on the canvas
+    void Draw(Canvas &canvas);
+
+private:
+    enum class Kind { None, Rain, Snow };
+
+    static const int kCapacity = 128;
+
+    void Step();
+    void Emit(int count);
+
+    int width_;
+    int height_;
+    ParticlePool particles_;
+    FastRandom random_;
+    Kind kind_ = Kind::None;
+    float accumulator_ = 0.0f;
+    bool ignoreNextDt_ = false;
+    // Fractional particles owed by the emission rate
+    float emitCredit_ = 0.0f;
+};
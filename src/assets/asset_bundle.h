@@ -0,0 +1,28 @@
+#pragma once
+
+// The clock's artwork, compiled in. asset_bundle_data.h is generated into the build directory
+// from resources/ by led_matrix_pack_assets (src/tools/asset_packer.cpp); this adds lookups on top.
+#include "asset_bundle_data.h"
+#include "raylib.h"
+
+#include <cstring>
+
+namespace asset_bundle {
+
+// Part of the icon atlas holding resources/<name>.png; empty (draws nothing) if it was not packed
+inline Rectangle IconRect(const char *name) {
+    for (int i = 0; i < kIconCount; i++) {
+        if (std::strcmp(kIconNames[i], name) == 0) {
+            return (Rectangle){(float)(i * kIconWidth), 0, (float)kIconWidth, (float)kIconHeight};
+        }
+    }
+    return (Rectangle){0, 0, 0, 0};
+}
+
+// Color for a temperature in whole degrees F; the scale covers 0 to kTemperatureColorCount - 1
+inline Color TemperatureColor(int degrees) {
+    const uint8_t* color = kTemperatureColors[degrees];
+    return (Color){color[0], color[1], color[2], color[3]};
+}
+
+}  // namespace asset_bundle
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <locale>
 #include <chrono>
@@ -7,21 +10,25 @@
 #include <fmt/core.h>
 #include "raylib.h"
 #include "matrix_driver.h"
+#include "metrics/allocation_counter.h"
+#include "metrics/clock_metrics.h"
+#include "metrics/frame_timing.h"
+#include "output/matrix_output.h"
+#include "render/frame_scheduler.h"
+#include "render/glyph_atlas.h"
+#include "render/layer_compositor.h"
+#include "render/render_backend.h"
+#include "time/time_service.h"
+#include "weather/weather_service.h"
 #include "animations/animation_manager.h"
-#include <nlohmann/json.hpp>
-#include <cpr/cpr.h>
-#include <boost/algorithm/string.hpp>    
-#include <regex>
-
-using json = nlohmann::json;
+#include "animations/weather_overlay.h"
+#include "assets/asset_bundle.h"
+#include <random>
+#include <sstream>
 
 const int texWidth = 64;
 const int texHeight = 32;
 
-const int screenZoomFactor = 10;
-const int screenWidth = texWidth * screenZoomFactor;
-const int screenHeight = texHeight * screenZoomFactor;
-
 uint64_t timeSinceEpochMillisec() {
   using namespace std::chrono;
   return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -31,81 +38,111 @@ long map(long x, long in_min, long in_max, long out_min, long out_max) {
   return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-double seconds_since_local_midnight() {
-  time_t now;
-  if (time(&now) == -1) {
-    return -1;
-  }
-  struct tm timestamp;
-  if (localtime_r(&now, &timestamp) == 0) { // C23
-    return -1;
-  }
-  timestamp.tm_isdst = -1; // Important
-  timestamp.tm_hour = 0;
-  timestamp.tm_min = 0;
-  timestamp.tm_sec = 0;
-  time_t midnight = mktime(&timestamp);
-  if (midnight == -1) {
-    return -1;
-  }
-  return difftime(now, midnight);
-}
+int main(int argc, char** argv) {
+    // Either a raylib window with a GL context, or the headless CPU rasterizer (--renderer=cpu)
+    std::unique_ptr<RenderBackend> backend = CreateRenderBackend(argc, argv, texWidth, texHeight);
+    MatrixDriver matrixDriver(&argc, &argv, texWidth, texHeight);
 
-void drawOutlinedText(const char* text, int x, int y, int size, Color bg, Color fg) {
-    DrawText(text, x-1, y-1, size, bg);
-    DrawText(text, x-0, y-1, size, bg);
-    DrawText(text, x+1, y-1, size, bg);
-    DrawText(text, x-1, y-0, size, bg);
-    DrawText(text, x-0, y-0, size, bg);
-    DrawText(text, x+1, y-0, size, bg);
-    DrawText(text, x-1, y+1, size, bg);
-    DrawText(text, x-0, y+1, size, bg);
-    DrawText(text, x+1, y+1, size, bg);
-
-    DrawText(text, x, y, size, fg);
-}
+    // Per-stage frame timing, summarized to the log once a minute
+    FrameTimings frameTimings;
+    FrameTimings::Snapshot lastTimingSummary = frameTimings.snapshot();
+    uint64_t lastTimingSummaryTime = timeSinceEpochMillisec();
 
-typedef enum WeatherType
-{
-    full_sun = 1,
-    full_moon = 8,
-    partial_sun = 2,
-    partial_moon = 7,
-    cloudy = 3,
-    cloudy_rain = 4,
-    cloudy_snow = 5,
-    cloudy_thunder = 6
-} WeatherType;
+    // Frames go to the panel from their own thread so a slow SwapOnVSync never stalls rendering
+    MatrixOutput matrixOutput(matrixDriver, texWidth, texHeight, &frameTimings);
+    matrixOutput.setCalibration(ColorCalibration::FromArgs(argc, argv));
+    matrixOutput.start();
 
-int main(int argc, char** argv) {
-    InitWindow(screenWidth, screenHeight, "LED Matrix Clock");
-    RenderTexture2D target = LoadRenderTexture(texWidth, texHeight);
-    RenderTexture2D targetSecondHandOverlay = LoadRenderTexture(texWidth, texHeight);
-    MatrixDriver matrixDriver(&argc, &argv, texWidth, texHeight);
+    // Served on /api/metrics; everything in here is read by the HTTP threads without locks
+    ClockMetrics clockMetrics(frameTimings, matrixOutput);
 
-    AnimationManager animationManager(texWidth, texHeight);
+    // Looping animations play from clips recorded at startup; --clip-cache-mb=0 renders them live
+    size_t clipCacheBytes = AnimationManager::kDefaultClipBudget;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--clip-cache-mb=", 16) == 0) {
+            clipCacheBytes = (size_t)std::max(std::atoi(argv[i] + 16), 0) << 20;
+        }
+    }
+    AnimationManager animationManager(texWidth, texHeight, clipCacheBytes);
     AnimationRequestServer animationServer(animationManager, 8080);
+    animationServer.SetMetrics(&clockMetrics);
     animationServer.Start();
 
+    // Frame rate while an animation plays; the clock face itself is only redrawn when it changes
     if (matrixDriver.isShim()) {
-        SetTargetFPS(30);
+        backend->SetTargetFps(30);
     } else {
-        SetTargetFPS(5);
+        backend->SetTargetFps(5);
+    }
+    FrameScheduler frameScheduler(std::chrono::milliseconds(50));
+
+    // Allocation counting builds can stop on the first warmed-up frame that touches the heap, so a
+    // headless run (--renderer=cpu) doubles as a test of the zero-allocation frame loop
+    bool failOnAllocation = false;
+    // Rain and snow over the clock face keep the loop drawing at the animation frame rate while
+    // they fall; --no-weather-overlay keeps the clock face static instead
+    bool weatherOverlayEnabled = true;
+    // --max-frames=<n> exits after n drawn frames, so such a run ends on its own
+    uint64_t maxFrames = 0;
+    // --animation=<name>[,<name>...] plays from startup, as if requested over the API
+    std::string startupAnimations;
+    // --fake-clock=<seconds> starts the clock face a quarter of an hour before the next local
+    // midnight and moves it on that many seconds per pass, so a short run crosses minutes, hours
+    // and a change of date
+    int fakeClockStep = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--fail-on-allocation") == 0) {
+            failOnAllocation = true;
+        } else if (std::strcmp(argv[i], "--no-weather-overlay") == 0) {
+            weatherOverlayEnabled = false;
+        } else if (std::strncmp(argv[i], "--max-frames=", 13) == 0) {
+            maxFrames = std::strtoull(argv[i] + 13, nullptr, 10);
+        } else if (std::strncmp(argv[i], "--animation=", 12) == 0) {
+            startupAnimations = argv[i] + 12;
+        } else if (std::strncmp(argv[i], "--fake-clock=", 13) == 0) {
+            fakeClockStep = std::max(std::atoi(argv[i] + 13), 0);
+        }
+    }
+    if (failOnAllocation && !allocation_counter::kEnabled) {
+        std::cout << "--fail-on-allocation needs a build with LED_CLOCK_COUNT_ALLOCATIONS=ON; ignoring it" << std::endl;
+    }
+    if (!startupAnimations.empty()) {
+        AnimationRequest request;
+        std::stringstream names(startupAnimations);
+        std::string name;
+        while (std::getline(names, name, ',') && request.playlistLength < AnimationRequest::kMaxPlaylist) {
+            std::optional<size_t> index = animationManager.FindAnimation(name);
+            if (index) {
+                request.playlist[request.playlistLength++] = (uint8_t)*index;
+            } else {
+                std::cout << "Unknown animation '" << name << "' in --animation" << std::endl;
+            }
+        }
+        if (request.playlistLength > 0) {
+            animationManager.Submit(request);
+        }
     }
 
+    // Fetches the forecast in the background; the loop below only reads its snapshots
+    WeatherOptions weatherOptions = WeatherOptions::FromArgs(argc, argv);
+    WeatherService weatherService(weatherOptions, &clockMetrics);
+    weatherService.start();
+    std::shared_ptr<const Forecast> shownForecast;
+    bool forecastStale = true;
 
-    int x = 0;
-    int y = 0;
-    int velX = 1;
-    int velY = 1;
 
-    
+    // Formatted once per second of wall time, and only when a frame is drawn
     char timeBuffer[256];
     char timeBuffer2[256];
     char timeBuffer3[256];
     char dateBuffer[256];
+    std::time_t formattedSecond = -1;
+    // Local time from a cached UTC offset; libc is only asked at midnight and DST changes
+    TimeService timeService;
 
     int temperatures[24];
+    // Formatted when a new forecast arrives
+    char temperatureText[16] = "60";
     int minTemperature = 60;
     int maxTemperature = 80;
 
@@ -114,45 +151,42 @@ int main(int argc, char** argv) {
     for (int i = 0; i < 24; i++) {
         temperatures[i] = 60;
     }
-    uint64_t lastWeatherQuery = 0;
-    json jsonWeatherData;
 
     bool dimMode = false;
     bool dimModeLatch = false;
 
-    std::regex rainRegex("rain");
-    std::regex snowRegex("snow");
-    std::regex chanceOfRegex("chance");
-    std::regex thunderRegex("thunder");
-    std::regex cloudyRegex("cloudy");
-    std::regex clearRegex("clear");
-    std::regex partlyRegex("partly");
-
     // Texture2D dayBg = LoadTextureFromImage(GenImageGradientV(texWidth, texHeight, (Color){0, 0, 0,255}, (Color){43, 169, 252,255}));
     // Texture2D parallaxBgImg = LoadTexture("resources/bg.png");
     WeatherType weatherEnum = WeatherType::full_sun;
 
 
-    Texture2D weatherIconCloud1 = LoadTexture("resources/weather-icon-cloud-1.png");
-    Texture2D weatherIconCloud2 = LoadTexture("resources/weather-icon-cloud-2.png");
-    Texture2D weatherIconCloud3 = LoadTexture("resources/weather-icon-cloud-3.png");
-    Texture2D weatherIconCloud4 = LoadTexture("resources/weather-icon-cloud-4.png");
-    Texture2D weatherIconSnow = LoadTexture("resources/weather-icon-snow.png");
-    Texture2D weatherIconMoonCloud1 = LoadTexture("resources/weather-icon-moon-cloud-1.png");
-    Texture2D weatherIconSun = LoadTexture("resources/weather-icon-sun.png");
-    Texture2D weatherIconMoon = LoadTexture("resources/weather-icon-moon.png");
+    // The icons and the temperature scale are compiled in (src/assets/asset_bundle.h), so
+    // nothing is read from disk and the icons upload as one atlas texture
+    CanvasTexture weatherIcons = backend->LoadTextureFromPixels(asset_bundle::kIconAtlas, asset_bundle::kIconAtlasWidth, asset_bundle::kIconHeight);
+    Rectangle weatherIconCloud1 = asset_bundle::IconRect("weather-icon-cloud-1");
+    Rectangle weatherIconCloud2 = asset_bundle::IconRect("weather-icon-cloud-2");
+    Rectangle weatherIconCloud3 = asset_bundle::IconRect("weather-icon-cloud-3");
+    Rectangle weatherIconCloud4 = asset_bundle::IconRect("weather-icon-cloud-4");
+    Rectangle weatherIconSnow = asset_bundle::IconRect("weather-icon-snow");
+    Rectangle weatherIconMoonCloud1 = asset_bundle::IconRect("weather-icon-moon-cloud-1");
+    Rectangle weatherIconSun = asset_bundle::IconRect("weather-icon-sun");
+    Rectangle weatherIconMoon = asset_bundle::IconRect("weather-icon-moon");
 
     float timeOfDayPercent = 0.0f;
 
     // Convert temperature as integer degree F into a table of colors
-    Texture2D temperatureScaleImg = LoadTexture("resources/temperature-scale.png");
-    Image colorLookupTable = LoadImageFromTexture(temperatureScaleImg);
     Color lookupColors[128];
     for (int i = 0; i < 128; i++) {
-        lookupColors[i] = GetImageColor(colorLookupTable, 0, i);
+        lookupColors[i] = asset_bundle::TemperatureColor(i);
     }
 
-    int secondInDay = seconds_since_local_midnight();
+    int secondInDay = timeService.now().secondOfDay;
+    std::time_t fakeClockSecond = 0;
+    if (fakeClockStep > 0) {
+        CivilTime startTime = timeService.now();
+        fakeClockSecond = startTime.epochSecond - startTime.secondOfDay + 24 * 60 * 60 - 15 * 60;
+        std::cout << "Faking the clock from 15 minutes before midnight, " << fakeClockStep << " s per pass" << std::endl;
+    }
     int sunriseSecondsTime = 5 * 60 * 60;
     int sunsetSecondsTime = 20 * 60 * 60;
 
@@ -161,9 +195,7 @@ int main(int argc, char** argv) {
     
      TODO: weather layers:
      - fog layer
-     - rain particle layer
      - lightning particle layer
-     - snow particle layer
      - cloud particle layer
 
      plot of temperature over the next 24 hours
@@ -171,220 +203,8 @@ int main(int argc, char** argv) {
      make temp curve darker based on sunset/sunrise
      */
 
-    while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
-        animationManager.Update(deltaTime);
-
-        // Query weather data if it is expired
-        if (timeSinceEpochMillisec() - lastWeatherQuery > 60000) {
-            std::cout << "Querying weather API..." << std::endl;
-            lastWeatherQuery = timeSinceEpochMillisec();
-
-            // Grab forecast from API call
-            cpr::Response r = cpr::Get(
-                cpr::Url{"https://api.open-meteo.com/v1/forecast?latitude=42.39&longitude=-71.10&hourly=temperature_2m,weathercode&timezone=America/New_York&current_weather=true&temperature_unit=fahrenheit&timeformat=unixtime&daily=sunrise,sunset"});
-
-
-
-
-            if (r.status_code == 200) {
-                try {
-                    json rawPayload = json::parse(r.text);
-                    //std::cout << rawPayload.dump(4) << std::endl;
-
-                    auto& currentWeather = rawPayload["current_weather"];
-
-                    std::vector<double> temperatureData = rawPayload["hourly"]["temperature_2m"];
-                    std::vector<uint64_t> timestamps = rawPayload["hourly"]["time"];
-
-                    // Find the next 24 temperature and forecast values
-                    int i = 0;
-                    for (auto& ts: timestamps) {
-                        if (ts >= (lastWeatherQuery / 1000)) {
-                            int hourRelative = (int)((ts - (lastWeatherQuery / 1000)) / 3600.0);
-                            double temperature = temperatureData[i];
-                            if (hourRelative < 24) {
-                                std::cout << "Hour: " << hourRelative << "Temp: " << temperature << std::endl;
-                                temperatures[hourRelative] = temperature;
-                            }
-                        }
-                        i += 1;
-                    }
-
-                    temperatures[0] = currentWeather["temperature"];
-                    int currentWeatherCode = currentWeather["weathercode"];
-                    uint64_t currentSunrise = rawPayload["daily"]["sunrise"][0];
-                    uint64_t currentSunset = rawPayload["daily"]["sunset"][0];
-
-                    currentSunrise *= 1000;
-                    currentSunset *= 1000;
-
-                    std::cout << "Sunrise today: " << currentSunrise << std::endl;
-                    std::cout << "Sunset today: " << currentSunset << std::endl;
-                    std::cout << "Current time: " << lastWeatherQuery << std::endl;
-
-                    bool isDaytime = false;
-                    if (lastWeatherQuery > (currentSunrise)) {
-                        // After sunrise
-                        isDaytime = true;
-                    }
-                    if (lastWeatherQuery > (currentSunset)) {
-                        // After sunset
-                        isDaytime = false;
-                    }
-
-                    std::cout << "Is daytime: " << isDaytime << std::endl;
-                    std::cout << "Current weather code: " << currentWeatherCode << std::endl;
-                    std::cout << "Current temperature: " << temperatures[0] << std::endl;
-
-                    // Weather codes at bottom of https://open-meteo.com/en/docs
-                    /*
-                    typedef enum WeatherType
-                    {
-                        full_sun = 1,
-                        full_moon = 8,
-                        partial_sun = 2,
-                        partial_moon = 7,
-                        cloudy = 3,
-                        cloudy_rain = 4,
-                        cloudy_snow = 5,
-                        cloudy_thunder = 6
-                    } WeatherType;
-                    */
-                    if (currentWeatherCode == 0 || currentWeatherCode == 1) {
-                        // Clear sky, mainly clear
-                        if (isDaytime) {
-                            weatherEnum = WeatherType::full_sun;
-                        } else {
-                            weatherEnum = WeatherType::full_moon;
-                        }
-                    } else if (currentWeatherCode == 2) {
-                        // Partly cloudy
-                        if (isDaytime) {
-                            weatherEnum = WeatherType::partial_sun;
-                        } else {
-                            weatherEnum = WeatherType::partial_moon;
-                        }
-                    } else if (
-                        currentWeatherCode == 3 || 
-                        currentWeatherCode == 45 || 
-                        currentWeatherCode == 48) {
-                        // Overcast, fog
-                        weatherEnum = WeatherType::cloudy;
-                    } else if (
-                        currentWeatherCode == 51 || 
-                        currentWeatherCode == 53 || 
-                        currentWeatherCode == 55 || 
-                        currentWeatherCode == 56 ||
-                        currentWeatherCode == 57 ||
-                        currentWeatherCode == 61 || 
-                        currentWeatherCode == 63 ||
-                        currentWeatherCode == 65 ||
-                        currentWeatherCode == 66 ||
-                        currentWeatherCode == 67 || 
-                        currentWeatherCode == 80 ||
-                        currentWeatherCode == 81 ||
-                        currentWeatherCode == 82) {
-                        // raining
-                        weatherEnum = WeatherType::cloudy_rain;
-                    } else if (
-                        currentWeatherCode == 71 ||
-                        currentWeatherCode == 73 ||
-                        currentWeatherCode == 75 ||
-                        currentWeatherCode == 77 ||
-                        currentWeatherCode == 85 ||
-                        currentWeatherCode == 86) {
-                        // snowing
-                        weatherEnum = WeatherType::cloudy_snow;
-                    } else if (
-                        currentWeatherCode == 95 ||
-                        currentWeatherCode == 96 ||
-                        currentWeatherCode == 99) {
-                        // thundering
-                        weatherEnum = WeatherType::cloudy_thunder;
-                    } else {
-                        // Default: partial sun or moon
-                        if (isDaytime) {
-                            weatherEnum = WeatherType::partial_sun;
-                        } else {
-                            weatherEnum = WeatherType::partial_moon;
-                        }
-                    }
-
-                } catch (std::exception &e) {
-                    std::cout << "Failed to parse weather API!" << e.what() << std::endl;
-                }
-            } else {
-                std::cout << "Failed to query weather API! Status code: " << r.status_code << "msg: " << r.text << std::endl;
-            }
-        }
-        secondInDay = seconds_since_local_midnight();
-
-        // Debug: toggle brightness
-        // On real device this is done with the hardware button
-        if (IsKeyDown(32) || matrixDriver.hardwareSwitchPressed()) {
-            //std::cout << "Button down" << std::endl;
-            if (!dimModeLatch) {
-                dimMode = !dimMode;
-                dimModeLatch = true;
-                std::cout << "Toggled dim mode to " << dimMode << std::endl;
-            }
-        } else {
-            //std::cout << "Button up" << std::endl;
-            dimModeLatch = false;
-        }
-
-        std::time_t now = std::time(nullptr);
-        std::strftime(timeBuffer, 256, "%I:%M%p", std::localtime(&now));
-        std::strftime(timeBuffer2, 256, "%I:%M", std::localtime(&now));
-        std::strftime(timeBuffer3, 256, "%M%p", std::localtime(&now));
-        std::strftime(dateBuffer, 256, "%b %e", std::localtime(&now));
-        // Handle updating clock state!
-
-        timeOfDayPercent = ((timeSinceEpochMillisec() / 100) % 1000) / 1000.0f;
- 
-        BeginDrawing();
-
-        if (animationManager.IsActive()) {
-            animationManager.Render(target);
-        } else {
-
-        BeginTextureMode(targetSecondHandOverlay);
-        ClearBackground((Color){0, 0, 0, 100});
-
-        auto time = std::localtime(&now);
-
-        float secPercent = time->tm_sec / 60.0f;
-        float hourPercent = time->tm_hour / 12.0f;
-        float minPercent = time->tm_min / 60.0f;
-        // float startAngle = 245.0f - (minPercent * 360.0f);
-        // float endAngle = 245.0f;
-        // DrawCircleSector((Vector2){32, 16}, 48.0f, startAngle, endAngle, 256, (Color){255,255,255,32});
-        // DrawCircleSector((Vector2){32, 16}, 48.0f, startAngle, startAngle + 10.0f, 256, (Color){255,255,255,255});
-
-        float secondAngleRad = ((secPercent * 360.0f) - 90.0f) * (PI/180.0f);
-        float minuteAngleRad = ((minPercent * 360.0f) - 90.0f) * (PI/180.0f);
-        float hourAngleRad = ((hourPercent * 360.0f) - 90.0f) * (PI/180.0f);
-        DrawLineEx((Vector2){32, 16}, (Vector2){32.0f + cos(hourAngleRad) * 100.0f, 16.0f + sin(hourAngleRad) * 100.0f}, 2.0f, (Color){255,255,255,215});
-        DrawRectangle(1,1,62, 30, (Color){0,0,0,40});
-        DrawLineEx((Vector2){32, 16}, (Vector2){32.0f + cos(minuteAngleRad) * 100.0f, 16.0f + sin(minuteAngleRad) * 100.0f}, 2.0f, (Color){255,255,255,235});
-        DrawRectangle(1,1,62, 30, (Color){0,0,0,40});
-        DrawLineEx((Vector2){32, 16}, (Vector2){32.0f + cos(secondAngleRad) * 100.0f, 16.0f + sin(secondAngleRad) * 100.0f}, 2.0f, (Color){255,255,255,255});
-        DrawRectangle(1,1,62, 30, (Color){0,0,0,230});
-
-
-
-
-        EndTextureMode();
-
-        // Render to internal buffer of same resolution as physical screen
-        BeginTextureMode(target);
-
-        // DrawTexture(dayBg, 0, 0, (Color){255,255,255,255});
-        ClearBackground((Color){0, 0, 0, 255});
-
-        // dither
-
+    // Current temperature mapped through the lookup table
+    auto currentTemperatureColor = [&]() {
         Color currentTempColor = (Color){255,255,255,255};
         if (temperatures[0] < 0) {
             currentTempColor = (Color){255,255,255,255};
@@ -394,11 +214,31 @@ int main(int argc, char** argv) {
             // Valid lookup
             currentTempColor = lookupColors[temperatures[0]];
         }
+        return currentTempColor;
+    };
+
+    // Outlined text styles, rasterized once up front
+    GlyphAtlas glyphAtlas(*backend);
+    const int timeText = glyphAtlas.AddStyle(5, (Color){255,255,255,255}, (Color){0,0,0,255});
+    const int smallText = glyphAtlas.AddStyle(2, (Color){255,255,255,255}, (Color){0,0,0,255});
+    const int dateText = glyphAtlas.AddStyle(2, (Color){128,128,128,255}, (Color){0,0,0,255});
+
+    // The clock face as cached layers, from the least to the most frequently changing. Each is
+    // only redrawn (with the layers above it) when its inputs change; see the checks in the loop.
+    LayerCompositor clockFace(*backend, texWidth, texHeight);
+
+    // Temperature-colored dither, with the time and date faintly behind everything else
+    const int backgroundLayer = clockFace.AddLayer("background", [&](Canvas &canvas) {
+        // DrawTexture(dayBg, 0, 0, (Color){255,255,255,255});
+
+        // dither
+
+        Color currentTempColor = currentTemperatureColor();
 
         for (int x = -1; x < 19; x++) {
             for (int y = -1; y < 32; y++) {
                 if ((x+y) % 2) {
-                    DrawPixel(x, y, Fade(currentTempColor, 0.3f));
+                    canvas.DrawPixel(x, y, Fade(currentTempColor, 0.3f));
                 }
             }
         }
@@ -407,40 +247,42 @@ int main(int argc, char** argv) {
         // DrawTexturePro(parallaxBgImg, (Rectangle){ 0, 0, 192,192 }, (Rectangle){32, 90, 192, 192}, (Vector2){96,96}, timeOfDayPercent * 360, WHITE); 
 
         // Draw time and date
-        drawOutlinedText(timeBuffer, 64 - MeasureText(timeBuffer, 5) - 2, 1, 5, (Color){0,0,0,255}, (Color){255,255,255,255});
-        drawOutlinedText(dateBuffer, 64 - MeasureText(dateBuffer, 5) - 2, 11, 2, (Color){0,0,0,255}, (Color){255,255,255,255});
+        glyphAtlas.DrawText(canvas, timeText, timeBuffer, 64 - glyphAtlas.MeasureText(timeText, timeBuffer) - 2, 1);
+        glyphAtlas.DrawText(canvas, smallText, dateBuffer, 64 - glyphAtlas.MeasureText(smallText, dateBuffer) - 2, 11);
 
         // make everything rendered before this half as bright
-        DrawRectangle(0, 0, 64, 32, (Color){0,0,0,128});
+        canvas.DrawRectangle(0, 0, 64, 32, (Color){0,0,0,128});
+    });
 
+    const int iconLayer = clockFace.AddLayer("weather icon", [&](Canvas &canvas) {
         // Draw weather icon
         if (weatherEnum == WeatherType::full_sun) {
-            DrawTexture(weatherIconSun, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconSun, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::partial_sun) {
-            DrawTexture(weatherIconCloud1, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconCloud1, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::cloudy) {
-            DrawTexture(weatherIconCloud2, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconCloud2, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::cloudy_rain) {
-            DrawTexture(weatherIconCloud3, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconCloud3, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::cloudy_snow) {
-            DrawTexture(weatherIconSnow, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconSnow, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::cloudy_thunder) {
-            DrawTexture(weatherIconCloud4, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconCloud4, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::partial_moon) {
-            DrawTexture(weatherIconMoonCloud1, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconMoonCloud1, 1, 11, (Color){255,255,255,255});
         } else if (weatherEnum == WeatherType::full_moon) {
-            DrawTexture(weatherIconMoon, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconMoon, 1, 11, (Color){255,255,255,255});
         } else {
-            DrawTexture(weatherIconCloud2, 1, 11, (Color){255,255,255,255});
+            canvas.DrawTextureRec(weatherIcons, weatherIconCloud2, 1, 11, (Color){255,255,255,255});
         }
+    });
 
-        
-        drawOutlinedText(timeBuffer2, 64 - MeasureText(timeBuffer, 5) - 2, 1, 5, (Color){0,0,0,255}, (Color){255,255,255,255});
-        
-        if (secondInDay % 2 == 0) {
-            DrawRectangle(64 - MeasureText(timeBuffer3, 5) - 4, 0, 1, 12, (Color){0,0,0,255});
-        }
+    const int timeLayer = clockFace.AddLayer("time", [&](Canvas &canvas) {
+        glyphAtlas.DrawText(canvas, timeText, timeBuffer2, 64 - glyphAtlas.MeasureText(timeText, timeBuffer) - 2, 1);
+    });
 
+    // 24 hour temperature graph and the current temperature
+    const int forecastLayer = clockFace.AddLayer("forecast", [&](Canvas &canvas) {
         // find max and min temperatures
         minTemperature = 999;
         maxTemperature = -999;
@@ -479,6 +321,10 @@ int main(int argc, char** argv) {
 
             float fadePrimaryAmount = 0.25f;
             float fadeSecondaryAmount = 0.6f;
+            if (forecastStale) {
+                fadePrimaryAmount = 0.1f;
+                fadeSecondaryAmount = 0.25f;
+            }
 
             int secondTime = i * 60 * 60;
             // if (secondTime <= sunriseSecondsTime || secondTime >= sunsetSecondsTime) {
@@ -487,11 +333,11 @@ int main(int argc, char** argv) {
             //     fadeSecondaryAmount = 0.05f;
             // }
 
-            DrawLine(temp_xx+1, temp_yy, temp_xx+1, 32, Fade(tempColor, fadePrimaryAmount));
-            DrawLine(temp_xx+2, temp_yy, temp_xx+2, 32, Fade(tempColor, fadePrimaryAmount));
+            canvas.DrawLine(temp_xx+1, temp_yy, temp_xx+1, 32, Fade(tempColor, fadePrimaryAmount));
+            canvas.DrawLine(temp_xx+2, temp_yy, temp_xx+2, 32, Fade(tempColor, fadePrimaryAmount));
 
-            DrawPixel(temp_xx, temp_yy,  Fade(tempColor, fadeSecondaryAmount));
-            DrawPixel(temp_xx+1, temp_yy,  Fade(tempColor, fadeSecondaryAmount));
+            canvas.DrawPixel(temp_xx, temp_yy,  Fade(tempColor, fadeSecondaryAmount));
+            canvas.DrawPixel(temp_xx+1, temp_yy,  Fade(tempColor, fadeSecondaryAmount));
 
         };
 
@@ -500,13 +346,14 @@ int main(int argc, char** argv) {
         // DrawLine(0,0,0,32, (Color){0,0,0,255});
 
         // draw icon on current temp
+        Color currentTempColor = currentTemperatureColor();
         int timeOfDay_yy = 31 - (map(temperatures[0], minTemperature, maxTemperature, 1, tempDisplayHeight));
-        DrawLine(19, 0, 19,  32, Fade(currentTempColor, 0.25f));
+        canvas.DrawLine(19, 0, 19,  32, Fade(currentTempColor, 0.25f));
 
         for (int i = 10; i >= 0.5; i = i * 0.8) {
             // DrawLine(19, timeOfDay_yy - i, 19,  timeOfDay_yy + i + 1, Fade(currentTempColor, 0.4f));
-            DrawLine(19, timeOfDay_yy - i, 19,  timeOfDay_yy + i + 1, Fade(currentTempColor, (10 - i) / 10.0f));
-            DrawLine(19 - (i/2), timeOfDay_yy, 19 + (i/2) + 1,  timeOfDay_yy, Fade(currentTempColor, (10 - i) / 10.0f));
+            canvas.DrawLine(19, timeOfDay_yy - i, 19,  timeOfDay_yy + i + 1, Fade(currentTempColor, (10 - i) / 10.0f));
+            canvas.DrawLine(19 - (i/2), timeOfDay_yy, 19 + (i/2) + 1,  timeOfDay_yy, Fade(currentTempColor, (10 - i) / 10.0f));
             // DrawLine(19 - (i/2) -1, timeOfDay_yy- (i/2), 19 + (i/2) + 1,  timeOfDay_yy+ (i/2), Fade(currentTempColor, (10 - i) / 10.0f));
             // DrawLine(19 - (i/2) -1, timeOfDay_yy+ (i/2), 19 + (i/2) + 1,  timeOfDay_yy- (i/2), Fade(currentTempColor, (10 - i) / 10.0f));
 
@@ -521,59 +368,218 @@ int main(int argc, char** argv) {
         // DrawRectangle(18, timeOfDay_yy, 1,1, (Color){0,0,0,255});
 
         // Draw temperature
-        drawOutlinedText(fmt::format("{}", temperatures[0]).c_str(), 2, 22, 2, (Color){0,0,0,255}, (Color){255,255,255,255});
+        glyphAtlas.DrawText(canvas, smallText, temperatureText, 2, 22);
 
         //DrawRectangle(0, 24, 64, 32, (Color){30,30,30,255});
-        int temperatureLength = MeasureText(fmt::format("{}", temperatures[0]).c_str(), 2);
-        DrawRectangle(2 + temperatureLength, 22, 5,5, (Color){0,0,0,255});
-        DrawRectangle(3 + temperatureLength, 23, 3,3, (Color){128,128,128,255});
-        DrawRectangle(4 + temperatureLength, 24, 1,1, (Color){0,0,0,255});
-
-        // BeginBlendMode(BLEND_ADDITIVE);
-        // DrawTexturePro(targetSecondHandOverlay.texture, (Rectangle){ 0, 0, 64, -32 }, (Rectangle){ 0, 0, 64, 32 }, (Vector2){0,0}, 0.0f, WHITE);           
-        // EndBlendMode();
+        int temperatureLength = glyphAtlas.MeasureText(smallText, temperatureText);
+        canvas.DrawRectangle(2 + temperatureLength, 22, 5,5, (Color){0,0,0,255});
+        canvas.DrawRectangle(3 + temperatureLength, 23, 3,3, (Color){128,128,128,255});
+        canvas.DrawRectangle(4 + temperatureLength, 24, 1,1, (Color){0,0,0,255});
+    });
+
+    // Blinks every second, so only the date sits above it. The graph used to be drawn after the
+    // colon, but the two never overlap, so the picture is the same.
+    const int colonLayer = clockFace.AddLayer("colon", [&](Canvas &canvas) {
+        if (secondInDay % 2 == 0) {
+            canvas.DrawRectangle(64 - glyphAtlas.MeasureText(timeText, timeBuffer3) - 4, 0, 1, 12, (Color){0,0,0,255});
+        }
+    });
+
+    const int dateLayer = clockFace.AddLayer("date", [&](Canvas &canvas) {
+        glyphAtlas.DrawText(canvas, dateText, dateBuffer, 64 - glyphAtlas.MeasureText(dateText, dateBuffer) - 2, 11);
+    });
+
+    // Rain or snow on top of the cached clock face, following the forecast
+    WeatherOverlay weatherOverlay(texWidth, texHeight, std::random_device{}());
+
+    // What the cached layers were drawn from
+    std::shared_ptr<const Forecast> composedForecast;
+    bool composedStale = false;
+    char composedTime[256] = "";
+    char composedDate[256] = "";
+    bool composedColon = false;
+
+    // Allocations are charged to the next drawn frame, idle passes included
+    const uint64_t kAllocationWarmupFrames = 10;
+    uint64_t framesDrawn = 0;
+    uint64_t allocationsBeforeFrame = allocation_counter::threadAllocations();
+    int exitCode = 0;
+
+    while (!backend->ShouldClose()) {
+        auto frameStart = std::chrono::steady_clock::now();
+        // The frame time runs from one drawn frame to the next, so after an idle stretch it spans
+        // the whole sleep. The manager and the overlay ignore the frame time that spans their own
+        // start; the clamp bounds what a frame that genuinely stalled can add.
+        float deltaTime = std::min(backend->FrameTime(), 0.25f);
+        {
+            ScopedStageTimer timer(frameTimings, FrameStage::AnimationUpdate);
+            animationManager.Update(deltaTime);
+            weatherOverlay.Update(deltaTime);
+        }
 
-        drawOutlinedText(dateBuffer, 64 - MeasureText(dateBuffer, 5) - 2, 11, 2, (Color){0,0,0,255}, (Color){128,128,128,255});
+        // Pick up the newest forecast, if the weather thread has published one
+        auto weatherStart = std::chrono::steady_clock::now();
+        std::shared_ptr<const Forecast> forecast = weatherService.latest();
+        if (forecast != shownForecast) {
+            shownForecast = forecast;
+            std::copy(forecast->temperatures.begin(), forecast->temperatures.end(), temperatures);
+            weatherEnum = forecast->type;
+            if (weatherOverlayEnabled) {
+                weatherOverlay.SetWeather(weatherEnum);
+            }
+            *fmt::format_to_n(temperatureText, sizeof(temperatureText) - 1, "{}", temperatures[0]).out = '\0';
+            frameScheduler.requestRedraw();
+        }
+        // Old or placeholder data is still drawn, but dimmed so it does not pass for current
+        forecastStale = weatherOptions.isStale(*forecast, timeSinceEpochMillisec());
+        frameTimings.record(FrameStage::WeatherPoll, std::chrono::steady_clock::now() - weatherStart);
+        // One clock read per frame, so every string drawn agrees on the second
+        CivilTime localTime = fakeClockStep > 0 ? timeService.at(fakeClockSecond += fakeClockStep)
+                                                : timeService.now();
+        std::time_t now = localTime.epochSecond;
+        if (now != formattedSecond) {
+            secondInDay = localTime.secondOfDay;
+            *fmt::format_to_n(timeBuffer, sizeof(timeBuffer) - 1, "{:02}:{:02}{}",
+                              localTime.hour12(), localTime.minute, localTime.meridiem()).out = '\0';
+            *fmt::format_to_n(timeBuffer2, sizeof(timeBuffer2) - 1, "{:02}:{:02}",
+                              localTime.hour12(), localTime.minute).out = '\0';
+            *fmt::format_to_n(timeBuffer3, sizeof(timeBuffer3) - 1, "{:02}{}",
+                              localTime.minute, localTime.meridiem()).out = '\0';
+            std::strcpy(dateBuffer, localTime.date);
+            formattedSecond = now;
+        }
 
-        EndTextureMode();
+        // Debug: toggle brightness
+        // On real device this is done with the hardware button
+        if (backend->IsKeyDown(KEY_SPACE) || matrixDriver.hardwareSwitchPressed()) {
+            //std::cout << "Button down" << std::endl;
+            if (!dimModeLatch) {
+                dimMode = !dimMode;
+                dimModeLatch = true;
+                std::cout << "Toggled dim mode to " << dimMode << std::endl;
+                frameScheduler.requestRedraw();
+            }
+        } else {
+            //std::cout << "Button up" << std::endl;
+            dimModeLatch = false;
         }
 
+        // Night and dim mode are applied by the output thread's LUT while it copies the frame
+        // to the panel, and fade in there without needing a new frame
+        float brightness = 1.0f;
         if ((secondInDay < (7 * 60 * 60) || (secondInDay > (22 * 60 * 60)))) {
-            BeginTextureMode(target);
-            BeginBlendMode(BLEND_MULTIPLIED);
-            DrawRectangle(0,0,texWidth,texHeight, (Color){128,128,128,255});
-            EndBlendMode();
-            EndTextureMode();
+            brightness *= 128.0f / 255.0f;
         }
-
         if (dimMode) {
-            BeginTextureMode(target);
-            BeginBlendMode(BLEND_MULTIPLIED);
-            DrawRectangle(0,0,texWidth,texHeight, (Color){64,64,64,255});
-            EndBlendMode();
-            EndTextureMode();
+            brightness *= 64.0f / 255.0f;
+        }
+        matrixOutput.setBrightness(brightness);
+
+        if (!frameScheduler.shouldDraw(animationManager.IsActive() || weatherOverlay.IsActive(), now)) {
+            backend->Idle(frameScheduler.nextWake());
+            continue;
+        }
+
+        // Handle updating clock state!
+
+        timeOfDayPercent = ((timeSinceEpochMillisec() / 100) % 1000) / 1000.0f;
+ 
+        auto drawStart = std::chrono::steady_clock::now();
+        backend->BeginFrame();
+
+        if (!animationManager.IsActive()) {
+            if (forecast != composedForecast) {
+                // The background dither is tinted by the current temperature
+                clockFace.Invalidate(backgroundLayer);
+                clockFace.Invalidate(iconLayer);
+                clockFace.Invalidate(forecastLayer);
+                composedForecast = forecast;
+            }
+            if (std::strcmp(timeBuffer, composedTime) != 0) {
+                clockFace.Invalidate(backgroundLayer);
+                clockFace.Invalidate(timeLayer);
+                clockFace.Invalidate(colonLayer);
+                std::strcpy(composedTime, timeBuffer);
+            }
+            if (std::strcmp(dateBuffer, composedDate) != 0) {
+                clockFace.Invalidate(backgroundLayer);
+                clockFace.Invalidate(dateLayer);
+                std::strcpy(composedDate, dateBuffer);
+            }
+            if (forecastStale != composedStale) {
+                clockFace.Invalidate(forecastLayer);
+                composedStale = forecastStale;
+            }
+            bool colon = secondInDay % 2 == 0;
+            if (colon != composedColon) {
+                clockFace.Invalidate(colonLayer);
+                composedColon = colon;
+            }
+            clockFace.Update();
+        }
+
+        // Render to internal buffer of same resolution as physical screen
+        Canvas& canvas = backend->Target().Begin();
+
+        if (animationManager.IsActive()) {
+            animationManager.Render(canvas);
+        } else {
+            canvas.CopySurface(clockFace.Result());
+            weatherOverlay.Draw(canvas);
         }
 
-        // Draw a debug UI on the software window
-        ClearBackground((Color){0, 0, 0, 255});
-        DrawTexturePro(target.texture, (Rectangle){ 0, 0, texWidth, -texHeight }, (Rectangle){ 0, 0, screenWidth, screenHeight }, (Vector2){0,0}, 0.0f, WHITE); 
+        backend->Target().End();
+        frameTimings.record(FrameStage::Draw, std::chrono::steady_clock::now() - drawStart);
+
+        // Present the frame (debug window on raylib) and wait for the target frame rate
+        backend->EndFrame();
 
-        EndDrawing();
+        // Grab the finished frame and hand it to the matrix output thread. Frames that come out
+        // identical to the last one (a weather refresh that changed nothing) are skipped there
+        // without touching the panel.
+        FrameView frame;
+        {
+            ScopedStageTimer timer(frameTimings, FrameStage::Readback);
+            frame = backend->ReadFrame();
+        }
+        {
+            ScopedStageTimer timer(frameTimings, FrameStage::Submit);
+            matrixOutput.submit(frame.pixels, frame.stride, frame.flipY);
+        }
 
-        // Grab each pixel in the texture and render to the LED matrix
-        // canvas->Clear();
-        Image canvasImage = LoadImageFromTexture(target.texture);
-        for (int xx = 0; xx < texWidth; xx++) {
-            for (int yy = 0; yy < texHeight; yy++) {
-                Color pix = GetImageColor(canvasImage, xx, yy);
-                matrixDriver.writePixel(xx, texHeight - yy - 1, pix.r, pix.g, pix.b);
+        frameTimings.record(FrameStage::Frame, std::chrono::steady_clock::now() - frameStart);
+        clockMetrics.frameRendered();
+        clockMetrics.publishActiveAnimation(animationManager.ActiveAnimationName());
+        framesDrawn++;
+        if (allocation_counter::kEnabled) {
+            uint64_t allocations = allocation_counter::threadAllocations() - allocationsBeforeFrame;
+            clockMetrics.frameAllocated(allocations);
+            if (failOnAllocation && allocations > 0 && framesDrawn > kAllocationWarmupFrames) {
+                std::cout << "Frame " << framesDrawn << " made " << allocations << " heap allocations" << std::endl;
+                exitCode = 1;
+                break;
             }
         }
-        matrixDriver.flipBuffer();
-        UnloadImage(canvasImage);
+        if (maxFrames > 0 && framesDrawn >= maxFrames) {
+            std::cout << "Stopping after " << framesDrawn << " frames (--max-frames)" << std::endl;
+            break;
+        }
+        if (timeSinceEpochMillisec() - lastTimingSummaryTime > 60000) {
+            FrameTimings::Snapshot timingSnapshot = frameTimings.snapshot();
+            std::cout << FrameTimings::summary(timingSnapshot, lastTimingSummary) << std::endl;
+            lastTimingSummary = timingSnapshot;
+            lastTimingSummaryTime = timeSinceEpochMillisec();
+        }
+        // The next frame's count starts after the summary, which allocates
+        allocationsBeforeFrame = allocation_counter::threadAllocations();
     }
 
+    weatherService.stop();
+    matrixOutput.stop();
+    std::cout << "Frames sent to matrix: " << matrixOutput.sentFrames()
+              << ", unchanged frames skipped: " << matrixOutput.skippedFrames()
+              << ", late frames dropped: " << matrixOutput.droppedFrames() << std::endl;
+
     animationServer.Stop();
-    CloseWindow();
-    return 0;
+    return exitCode;
 }
@@ -1,5 +1,9 @@
+#pragma once
+
 #include <iostream>
+#include <cstdint>
 #include <fmt/core.h>
+#include "output/color_lut.h"
 
 class MatrixDriver {
     private:
@@ -13,6 +17,13 @@ class MatrixDriver {
         void stop();
 
         void writePixel(int x, int y, int r, int g, int b);
+
+        // Copies a whole frame of 32-bit RGBA pixels (alpha is ignored) to the back buffer in one
+        // pass. `stride` is the distance in bytes between rows, and `flipY` treats the first row
+        // as the bottom of the panel (which is how GL hands back render textures). Every pixel
+        // is overwritten, so the back buffer does not need to be cleared first. Each channel is
+        // mapped through `lut` on the way (brightness and calibration).
+        void writeFrame(const uint8_t* rgba, int stride, bool flipY, const ColorLut &lut);
         void flipBuffer();
 
         bool isShim();
@@ -1,7 +1,6 @@
 #include "matrix_driver.h"
 #include "led-matrix.h"
 #include "graphics.h"
-#include <unistd.h>
 #include <wiringPi.h>
 
 using rgb_matrix::RGBMatrix;
@@ -35,7 +34,11 @@ MatrixDriver::MatrixDriver(int* argc, char **argv[], int _width, int _height) {
     matrix = RGBMatrix::CreateFromFlags(argc, argv, &matrix_options);
     canvas = matrix->CreateFrameCanvas();
 
-    usleep(2000000);
+    // Wait until the refresh thread is actually driving the panel instead of sleeping for a fixed
+    // two seconds: SwapOnVSync() returns once the refresh loop has taken the (blank) buffer, which
+    // takes one refresh period.
+    canvas->Clear();
+    canvas = matrix->SwapOnVSync(canvas);
 }
 
 MatrixDriver::~MatrixDriver() {
@@ -57,10 +60,20 @@ void MatrixDriver::writePixel(int x, int y, int r, int g, int b) {
     canvas->SetPixel(x,y,r,g,b);
 }
 
+void MatrixDriver::writeFrame(const uint8_t* rgba, int stride, bool flipY, const ColorLut &lut) {
+    for (int yy = 0; yy < height; yy++) {
+        const uint8_t* row = rgba + (flipY ? (height - yy - 1) : yy) * stride;
+        for (int xx = 0; xx < width; xx++) {
+            canvas->SetPixel(xx, yy, lut.red(row[0]), lut.green(row[1]), lut.blue(row[2]));
+            row += 4;
+        }
+    }
+}
+
 void MatrixDriver::flipBuffer() {
     //std::cout << "Flipping pixel buffer" << std::endl;
+    // The returned canvas still holds an older frame; writeFrame() overwrites all of it
     canvas = matrix->SwapOnVSync(canvas);
-    canvas->Fill(0,0,0);
 }
 
 bool MatrixDriver::isShim() {
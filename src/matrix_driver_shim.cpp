@@ -1,14 +1,43 @@
 #include "matrix_driver.h"
+#include "output/frame_recording.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// With --record=<file> the shim keeps the frames it is given and streams them to a recording
+// that tools/frame_replay.cpp can play back on a real panel or dump to PNGs.
+std::unique_ptr<FrameRecorder> recorder;
+std::vector<uint8_t> shimFrame;
 
 MatrixDriver::MatrixDriver(int* argc, char **argv[], int _width, int _height) {
     std::cout << "Initializing shim matrix driver" << std::endl;
 
     this->width = _width;
     this->height = _height;
+
+    const char* recordFlag = "--record=";
+    for (int i = 1; i < *argc; i++) {
+        if (std::strncmp((*argv)[i], recordFlag, std::strlen(recordFlag)) == 0) {
+            std::string path = (*argv)[i] + std::strlen(recordFlag);
+            recorder = std::make_unique<FrameRecorder>(path, width, height);
+            if (recorder->isOpen()) {
+                std::cout << "Recording matrix frames to " << path << std::endl;
+            } else {
+                std::cout << "Failed to open frame recording " << path << std::endl;
+                recorder.reset();
+            }
+        }
+    }
+    shimFrame.assign(width * height * 3, 0);
 }
 
 MatrixDriver::~MatrixDriver() {
     std::cout << "Destroying shim matrix driver" << std::endl;
+    if (recorder) {
+        std::cout << "Recorded " << recorder->framesWritten() << " frames" << std::endl;
+        recorder.reset();
+    }
 }
 
 void MatrixDriver::start() {
@@ -23,10 +52,38 @@ void MatrixDriver::stop() {
 
 void MatrixDriver::writePixel(int x, int y, int r, int g, int b) {
     // std::cout << fmt::format("Writing shim pixel (x = {}, y = {}): {}, {}, {}", x, y, r, g, b) << std::endl;
+    if (!recorder || x < 0 || y < 0 || x >= width || y >= height) {
+        return;
+    }
+    uint8_t* pixel = shimFrame.data() + (y * width + x) * 3;
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+}
+
+void MatrixDriver::writeFrame(const uint8_t* rgba, int stride, bool flipY, const ColorLut &lut) {
+    // std::cout << fmt::format("Writing shim frame ({}x{}, stride {}, flipY {})", width, height, stride, flipY) << std::endl;
+    if (!recorder) {
+        return;
+    }
+    uint8_t* out = shimFrame.data();
+    for (int yy = 0; yy < height; yy++) {
+        const uint8_t* row = rgba + (flipY ? (height - yy - 1) : yy) * stride;
+        for (int xx = 0; xx < width; xx++) {
+            out[0] = lut.red(row[0]);
+            out[1] = lut.green(row[1]);
+            out[2] = lut.blue(row[2]);
+            out += 3;
+            row += 4;
+        }
+    }
 }
 
 void MatrixDriver::flipBuffer() {
     // std::cout << "Flipping shim pixel buffer" << std::endl;
+    if (recorder) {
+        recorder->writeFrame(shimFrame.data());
+    }
 }
 
 bool MatrixDriver::isShim() {
@@ -35,4 +92,4 @@ bool MatrixDriver::isShim() {
 
 bool MatrixDriver::hardwareSwitchPressed() {
     return false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,79 @@
+#include "metrics/allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Trivially constructible, so it is usable from operator new before anything else in the thread
+thread_local uint64_t threadAllocationCount = 0;
+
+}  // namespace
+
+uint64_t allocation_counter::threadAllocations() {
+    return threadAllocationCount;
+}
+
+#ifdef LED_CLOCK_COUNT_ALLOCATIONS
+
+// The array and nothrow forms are replaced too, so every allocation counts once whichever standard
+// library is in use. All of them allocate with malloc(), which keeps them matched with the
+// replaced deletes below. Over-aligned allocations keep the library's own operators.
+namespace {
+
+void* countedAllocate(std::size_t size) {
+    threadAllocationCount++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    void* block = countedAllocate(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new[](std::size_t size) {
+    void* block = countedAllocate(size);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, const std::nothrow_t &) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t &) noexcept {
+    std::free(block);
+}
+
+#endif
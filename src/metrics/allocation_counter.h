@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug count of heap allocations made through operator new, per thread. Builds configured with
+// -DLED_CLOCK_COUNT_ALLOCATIONS=ON replace the global operator new to keep the count; in every
+// other build counting is compiled out and the count stays at zero. Plain malloc() calls (raylib's
+// own allocations, for instance) are not seen.
+namespace allocation_counter {
+
+#ifdef LED_CLOCK_COUNT_ALLOCATIONS
+const bool kEnabled = true;
+#else
+const bool kEnabled = false;
+#endif
+
+// Allocations made by the calling thread since it started
+uint64_t threadAllocations();
+
+}  // namespace allocation_counter
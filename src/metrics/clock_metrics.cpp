@@ -0,0 +1,184 @@
+#include "metrics/clock_metrics.h"
+#include "metrics/allocation_counter.h"
+
+#include <fstream>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+namespace {
+
+uint64_t residentSetBytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t sizePages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> sizePages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+nlohmann::json histogramJson(const LatencyHistogram::Snapshot &snap) {
+    nlohmann::json out;
+    out["count"] = snap.count;
+    out["sum_us"] = snap.sumMicros;
+    out["mean_us"] = snap.meanMicros();
+    out["min_us"] = snap.minMicros;
+    out["max_us"] = snap.maxMicros;
+    out["p50_us"] = snap.percentile(0.5);
+    out["p90_us"] = snap.percentile(0.9);
+    out["p99_us"] = snap.percentile(0.99);
+    // Only the non-empty buckets, as [upper bound in us, count] pairs
+    nlohmann::json buckets = nlohmann::json::array();
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        if (snap.buckets[i] > 0) {
+            buckets.push_back({LatencyHistogram::bucketUpperBound(i), snap.buckets[i]});
+        }
+    }
+    out["buckets"] = buckets;
+    return out;
+}
+
+// Prometheus buckets have to be cumulative and stable between scrapes, so report the power of
+// two boundaries (every fourth internal bucket) from 16 us to ~16 s. Samples are whole
+// microseconds and a bucket ends just below a power of two, so `le` is 2^p - 1 us: a sample of
+// exactly 2^p us falls in the next bucket, and the label must not claim it.
+void appendPrometheusHistogram(std::string &out,
+                               const char* name,
+                               const std::string &labels,
+                               const LatencyHistogram::Snapshot &snap) {
+    const char* separator = labels.empty() ? "" : ",";
+    uint64_t cumulative = 0;
+    int next = 0;
+    for (int power = 4; power <= 24; power++) {
+        uint32_t limit = (1u << power) - 1;
+        while (next < LatencyHistogram::kBucketCount && LatencyHistogram::bucketUpperBound(next) <= limit) {
+            cumulative += snap.buckets[next++];
+        }
+        out += fmt::format("{}_bucket{{{}{}le=\"{}\"}} {}\n", name, labels, separator, limit / 1e6, cumulative);
+    }
+    // +Inf and _count come from the same buckets rather than from snap.count, which is loaded
+    // separately and can trail a sample that already landed in a bucket
+    while (next < LatencyHistogram::kBucketCount) {
+        cumulative += snap.buckets[next++];
+    }
+    out += fmt::format("{}_bucket{{{}{}le=\"+Inf\"}} {}\n", name, labels, separator, cumulative);
+    out += fmt::format("{}_sum{{{}}} {:g}\n", name, labels, snap.sumMicros / 1e6);
+    out += fmt::format("{}_count{{{}}} {}\n", name, labels, cumulative);
+}
+
+}  // namespace
+
+void ClockMetrics::frameRendered() {
+    fpsWindowFrames_++;
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - fpsWindowStart_).count();
+    if (elapsed >= 1.0) {
+        achievedFps_.store(fpsWindowFrames_ / elapsed, std::memory_order_relaxed);
+        fpsWindowFrames_ = 0;
+        fpsWindowStart_ = now;
+    }
+}
+
+void ClockMetrics::weatherFetched(std::chrono::steady_clock::duration latency, bool succeeded) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    weatherLatency_.record(micros > UINT32_MAX ? UINT32_MAX : (uint32_t)micros);
+    weatherFetches_.fetch_add(1, std::memory_order_relaxed);
+    if (!succeeded) {
+        weatherFailures_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+nlohmann::json ClockMetrics::toJson() const {
+    nlohmann::json out;
+    nlohmann::json stages;
+    for (int i = 0; i < FrameTimings::kStageCount; i++) {
+        FrameStage stage = (FrameStage)i;
+        stages[FrameTimings::stageName(stage)] = histogramJson(frameTimings_.histogram(stage).snapshot());
+    }
+    out["frame_timing"] = stages;
+    out["fps"] = achievedFps_.load(std::memory_order_relaxed);
+    out["frames"] = {
+        {"sent", output_.sentFrames()},
+        {"skipped_unchanged", output_.skippedFrames()},
+        {"dropped_late", output_.droppedFrames()},
+    };
+    out["weather"] = {
+        {"fetches", weatherFetches_.load(std::memory_order_relaxed)},
+        {"failures", weatherFailures_.load(std::memory_order_relaxed)},
+        {"latency", histogramJson(weatherLatency_.snapshot())},
+    };
+    const char* animation = activeAnimation_.load(std::memory_order_acquire);
+    out["active_animation"] = animation ? nlohmann::json(animation) : nlohmann::json(nullptr);
+    if (allocation_counter::kEnabled) {
+        out["render_allocations"] = {
+            {"total", frameAllocations_.load(std::memory_order_relaxed)},
+            {"allocating_frames", allocatingFrames_.load(std::memory_order_relaxed)},
+        };
+    }
+    int64_t startupMicros = output_.startupMicros();
+    out["startup_seconds"] = startupMicros >= 0 ? nlohmann::json(startupMicros / 1e6) : nlohmann::json(nullptr);
+    out["process_rss_bytes"] = residentSetBytes();
+    return out;
+}
+
+std::string ClockMetrics::toPrometheus() const {
+    std::string out;
+    out += "# HELP led_clock_stage_seconds Time spent in each stage of the frame loop.\n";
+    out += "# TYPE led_clock_stage_seconds histogram\n";
+    for (int i = 0; i < FrameTimings::kStageCount; i++) {
+        FrameStage stage = (FrameStage)i;
+        std::string labels = fmt::format("stage=\"{}\"", FrameTimings::stageName(stage));
+        appendPrometheusHistogram(out, "led_clock_stage_seconds", labels, frameTimings_.histogram(stage).snapshot());
+    }
+
+    out += "# HELP led_clock_fps Frames rendered per second over the last second.\n";
+    out += "# TYPE led_clock_fps gauge\n";
+    out += fmt::format("led_clock_fps {:g}\n", achievedFps_.load(std::memory_order_relaxed));
+
+    out += "# HELP led_clock_frames_total Frames handled by the matrix output thread.\n";
+    out += "# TYPE led_clock_frames_total counter\n";
+    out += fmt::format("led_clock_frames_total{{result=\"sent\"}} {}\n", output_.sentFrames());
+    out += fmt::format("led_clock_frames_total{{result=\"skipped_unchanged\"}} {}\n", output_.skippedFrames());
+    out += fmt::format("led_clock_frames_total{{result=\"dropped_late\"}} {}\n", output_.droppedFrames());
+
+    out += "# HELP led_clock_weather_fetches_total Weather API requests.\n";
+    out += "# TYPE led_clock_weather_fetches_total counter\n";
+    out += fmt::format("led_clock_weather_fetches_total {}\n", weatherFetches_.load(std::memory_order_relaxed));
+    out += "# HELP led_clock_weather_failures_total Weather API requests that failed or did not parse.\n";
+    out += "# TYPE led_clock_weather_failures_total counter\n";
+    out += fmt::format("led_clock_weather_failures_total {}\n", weatherFailures_.load(std::memory_order_relaxed));
+    out += "# HELP led_clock_weather_fetch_seconds Weather API request latency.\n";
+    out += "# TYPE led_clock_weather_fetch_seconds histogram\n";
+    appendPrometheusHistogram(out, "led_clock_weather_fetch_seconds", "", weatherLatency_.snapshot());
+
+    const char* animation = activeAnimation_.load(std::memory_order_acquire);
+    out += "# HELP led_clock_animation_active Whether an animation replaces the clock face, by name.\n";
+    out += "# TYPE led_clock_animation_active gauge\n";
+    if (animation != nullptr) {
+        out += fmt::format("led_clock_animation_active{{animation=\"{}\"}} 1\n", animation);
+    } else {
+        out += "led_clock_animation_active{animation=\"\"} 0\n";
+    }
+
+    if (allocation_counter::kEnabled) {
+        out += "# HELP led_clock_render_allocations_total Heap allocations made while drawing frames.\n";
+        out += "# TYPE led_clock_render_allocations_total counter\n";
+        out += fmt::format("led_clock_render_allocations_total {}\n", frameAllocations_.load(std::memory_order_relaxed));
+        out += "# HELP led_clock_allocating_frames_total Frames that made at least one heap allocation.\n";
+        out += "# TYPE led_clock_allocating_frames_total counter\n";
+        out += fmt::format("led_clock_allocating_frames_total {}\n", allocatingFrames_.load(std::memory_order_relaxed));
+    }
+
+    int64_t startupMicros = output_.startupMicros();
+    if (startupMicros >= 0) {
+        out += "# HELP led_clock_startup_seconds Time from process start to the first frame on the panel.\n";
+        out += "# TYPE led_clock_startup_seconds gauge\n";
+        out += fmt::format("led_clock_startup_seconds {:g}\n", startupMicros / 1e6);
+    }
+
+    out += "# HELP process_resident_memory_bytes Resident memory size in bytes.\n";
+    out += "# TYPE process_resident_memory_bytes gauge\n";
+    out += fmt::format("process_resident_memory_bytes {}\n", residentSetBytes());
+    return out;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "metrics/frame_timing.h"
+#include "output/matrix_output.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+// Everything /api/metrics reports. The render thread, the output thread and the weather code
+// write plain atomics (or single-writer histograms), and the HTTP threads read them without any
+// lock, so scraping never contends with AnimationManager or the render loop.
+class ClockMetrics {
+public:
+    ClockMetrics(const FrameTimings &frameTimings, const MatrixOutput &output)
+        : frameTimings_(frameTimings), output_(output) {}
+
+    ClockMetrics(const ClockMetrics &) = delete;
+    ClockMetrics &operator=(const ClockMetrics &) = delete;
+
+    // Render thread: called once per frame, publishes the frame rate about once a second
+    void frameRendered();
+
+    // Render thread: the name must outlive the metrics (Animation::Name() literals do)
+    void publishActiveAnimation(const char* name) {
+        activeAnimation_.store(name, std::memory_order_release);
+    }
+
+    // Render thread: heap allocations made by the frame, in allocation counting builds
+    void frameAllocated(uint64_t allocations) {
+        frameAllocations_.fetch_add(allocations, std::memory_order_relaxed);
+        if (allocations > 0) {
+            allocatingFrames_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Weather code: one call per fetch attempt
+    void weatherFetched(std::chrono::steady_clock::duration latency, bool succeeded);
+
+    nlohmann::json toJson() const;
+    // Prometheus text exposition format, version 0.0.4
+    std::string toPrometheus() const;
+
+private:
+    const FrameTimings &frameTimings_;
+    const MatrixOutput &output_;
+
+    std::chrono::steady_clock::time_point fpsWindowStart_ = std::chrono::steady_clock::now();
+    uint64_t fpsWindowFrames_ = 0;
+    std::atomic<double> achievedFps_{0.0};
+
+    std::atomic<const char*> activeAnimation_{nullptr};
+
+    std::atomic<uint64_t> frameAllocations_{0};
+    std::atomic<uint64_t> allocatingFrames_{0};
+
+    LatencyHistogram weatherLatency_;
+    std::atomic<uint64_t> weatherFetches_{0};
+    std::atomic<uint64_t> weatherFailures_{0};
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <fmt/core.h>
+
+// Fixed-bucket latency histogram in microseconds. Buckets are log-linear: one each for 0-3 us,
+// then four per power of two from 4 us, so a percentile read from them is within 25% of the real
+// value. The 96 counters reach 2^25 us (~33 s); anything longer lands in the last one. Recording
+// is a handful of relaxed atomic adds, cheap enough to leave on in production. Each histogram has
+// a single writer; any thread may read it.
+class LatencyHistogram {
+public:
+    static const int kBucketCount = 96;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sumMicros = 0;
+        uint32_t minMicros = 0;
+        uint32_t maxMicros = 0;
+        std::array<uint64_t, kBucketCount> buckets{};
+
+        // Upper bound of the bucket holding the given fraction (0..1) of the samples
+        uint32_t percentile(double fraction) const {
+            if (count == 0) {
+                return 0;
+            }
+            uint64_t rank = (uint64_t)(fraction * (count - 1)) + 1;
+            uint64_t seen = 0;
+            for (int i = 0; i < kBucketCount; i++) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::min(bucketUpperBound(i), maxMicros);
+                }
+            }
+            return maxMicros;
+        }
+
+        double meanMicros() const {
+            return count ? (double)sumMicros / count : 0.0;
+        }
+
+        // Samples recorded since `earlier` (min/max are not windowed and stay all-time)
+        Snapshot since(const Snapshot &earlier) const {
+            Snapshot window = *this;
+            window.count -= earlier.count;
+            window.sumMicros -= earlier.sumMicros;
+            for (int i = 0; i < kBucketCount; i++) {
+                window.buckets[i] -= earlier.buckets[i];
+            }
+            return window;
+        }
+    };
+
+    void record(uint32_t micros) {
+        buckets_[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        if (micros < min_.load(std::memory_order_relaxed)) {
+            min_.store(micros, std::memory_order_relaxed);
+        }
+        if (micros > max_.load(std::memory_order_relaxed)) {
+            max_.store(micros, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        snap.count = count_.load(std::memory_order_relaxed);
+        snap.sumMicros = sum_.load(std::memory_order_relaxed);
+        snap.minMicros = snap.count ? min_.load(std::memory_order_relaxed) : 0;
+        snap.maxMicros = max_.load(std::memory_order_relaxed);
+        for (int i = 0; i < kBucketCount; i++) {
+            snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snap;
+    }
+
+    static int bucketFor(uint32_t micros) {
+        if (micros < 4) {
+            return micros;
+        }
+        int msb = 31 - __builtin_clz(micros);
+        int sub = (micros >> (msb - 2)) & 3;
+        int index = 4 + (msb - 2) * 4 + sub;
+        return index < kBucketCount ? index : kBucketCount - 1;
+    }
+
+    static uint32_t bucketUpperBound(int index) {
+        if (index < 4) {
+            return index;
+        }
+        int msb = (index - 4) / 4 + 2;
+        int sub = (index - 4) % 4;
+        uint64_t lower = (uint64_t)(4 + sub) << (msb - 2);
+        uint64_t upper = lower + ((uint64_t)1 << (msb - 2)) - 1;
+        return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint32_t> min_{UINT32_MAX};
+    std::atomic<uint32_t> max_{0};
+};
+
+// The stages of one trip through the main loop, plus the two that run on the matrix output thread
+enum class FrameStage {
+    Frame,
+    WeatherPoll,
+    AnimationUpdate,
+    Draw,
+    Readback,
+    Submit,
+    MatrixWrite,
+    FlipBuffer,
+    Count
+};
+
+class FrameTimings {
+public:
+    static const int kStageCount = (int)FrameStage::Count;
+
+    using Snapshot = std::array<LatencyHistogram::Snapshot, kStageCount>;
+
+    static const char *stageName(FrameStage stage) {
+        static const char* names[kStageCount] = {
+            "frame", "weather", "anim_update", "draw", "readback", "submit", "matrix_write", "flip"};
+        return names[(int)stage];
+    }
+
+    void record(FrameStage stage, std::chrono::steady_clock::duration elapsed) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        histograms_[(int)stage].record(micros > UINT32_MAX ? UINT32_MAX : (uint32_t)micros);
+    }
+
+    const LatencyHistogram &histogram(FrameStage stage) const {
+        return histograms_[(int)stage];
+    }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        for (int i = 0; i < kStageCount; i++) {
+            snap[i] = histograms_[i].snapshot();
+        }
+        return snap;
+    }
+
+    // One line covering the samples since `previous`: count and mean/p50/p99 per stage, with
+    // all-time min and max
+    static std::string summary(const Snapshot &current, const Snapshot &previous) {
+        std::string line = "Frame timing (us):";
+        for (int i = 0; i < kStageCount; i++) {
+            LatencyHistogram::Snapshot window = current[i].since(previous[i]);
+            if (window.count == 0) {
+                continue;
+            }
+            line += fmt::format(" {} n={} mean={:.0f} p50={} p99={} min={} max={} |",
+                                stageName((FrameStage)i),
+                                window.count,
+                                window.meanMicros(),
+                                window.percentile(0.5),
+                                window.percentile(0.99),
+                                window.minMicros,
+                                window.maxMicros);
+        }
+        if (line.back() == '|') {
+            line.pop_back();
+        }
+        return line;
+    }
+
+private:
+    std::array<LatencyHistogram, kStageCount> histograms_;
+};
+
+// Records the time between construction and destruction against one stage
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(FrameTimings &timings, FrameStage stage)
+        : timings_(timings), stage_(stage), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStageTimer() {
+        timings_.record(stage_, std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedStageTimer(const ScopedStageTimer &) = delete;
+    ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+private:
+    FrameTimings &timings_;
+    FrameStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
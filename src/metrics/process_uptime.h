@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+// Time since the kernel started this process, so a startup measurement includes exec, dynamic
+// linking and static initialisation rather than starting at main(). The start time comes from
+// /proc/self/stat in clock ticks (10 ms on most kernels). Returns false without /proc.
+inline bool processUptime(std::chrono::microseconds &uptime) {
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    if (!std::getline(stat, line)) {
+        return false;
+    }
+    // The command name in field 2 may contain spaces, so count fields from its closing bracket
+    size_t nameEnd = line.rfind(')');
+    if (nameEnd == std::string::npos) {
+        return false;
+    }
+    std::istringstream fields(line.substr(nameEnd + 1));
+    std::string field;
+    // Field 22 is the start time; the stream starts at field 3
+    for (int i = 3; i <= 22; i++) {
+        if (!(fields >> field)) {
+            return false;
+        }
+    }
+    long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    struct timespec sinceBoot;
+    if (ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &sinceBoot) != 0) {
+        return false;
+    }
+    double startSeconds = std::strtoull(field.c_str(), nullptr, 10) / (double)ticksPerSecond;
+    double nowSeconds = sinceBoot.tv_sec + sinceBoot.tv_nsec / 1e9;
+    uptime = std::chrono::microseconds((long long)((nowSeconds - startSeconds) * 1e6));
+    return true;
+}
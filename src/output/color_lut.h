@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Per-channel response of the panel. The rgbmatrix library already applies CIE1931 luminance
+// correction when it maps 8-bit values to PWM, so the defaults are linear; `--gamma=` and
+// `--white-balance=` are for panels whose channels still come out uneven.
+struct ColorCalibration {
+    float gamma[3] = {1.0f, 1.0f, 1.0f};
+    float gain[3] = {1.0f, 1.0f, 1.0f};
+
+    // Accepts `--gamma=2.2` or `--gamma=r,g,b`, and `--white-balance=r,g,b` (gains, 0..1)
+    static ColorCalibration FromArgs(int argc, char **argv) {
+        ColorCalibration calibration;
+        for (int i = 1; i < argc; i++) {
+            if (std::strncmp(argv[i], "--gamma=", 8) == 0) {
+                parseTriple(argv[i] + 8, calibration.gamma, "--gamma");
+            } else if (std::strncmp(argv[i], "--white-balance=", 16) == 0) {
+                parseTriple(argv[i] + 16, calibration.gain, "--white-balance");
+            }
+        }
+        return calibration;
+    }
+
+private:
+    static void parseTriple(const char* text, float out[3], const char* flag) {
+        float values[3];
+        int count = 0;
+        const char* cursor = text;
+        while (count < 3) {
+            char* end = nullptr;
+            float value = std::strtof(cursor, &end);
+            if (end == cursor || !(value > 0.0f)) {
+                break;
+            }
+            values[count++] = value;
+            cursor = end;
+            if (*cursor != ',') {
+                break;
+            }
+            cursor++;
+        }
+        if (*cursor != '\0' || (count != 1 && count != 3)) {
+            std::cout << "Ignoring " << flag << "='" << text << "', expected one or three positive numbers" << std::endl;
+            return;
+        }
+        for (int c = 0; c < 3; c++) {
+            out[c] = values[count == 1 ? 0 : c];
+        }
+    }
+};
+
+// Brightness and calibration folded into one 256-entry table per channel, applied while frames
+// are copied to the matrix. Replaces the full-screen multiply passes the render loop used to do
+// for night and dim mode; a lookup per channel is all the output copy pays for it.
+class ColorLut {
+public:
+    ColorLut() {
+        build(1.0f, ColorCalibration{});
+    }
+
+    void build(float brightness, const ColorCalibration &calibration) {
+        brightness = std::clamp(brightness, 0.0f, 1.0f);
+        for (int c = 0; c < 3; c++) {
+            float scale = 255.0f * brightness * std::clamp(calibration.gain[c], 0.0f, 1.0f);
+            for (int v = 0; v < 256; v++) {
+                float level = std::pow(v / 255.0f, calibration.gamma[c]) * scale;
+                table_[c][v] = (uint8_t)std::lround(std::min(level, 255.0f));
+            }
+        }
+    }
+
+    uint8_t red(uint8_t v) const {
+        return table_[0][v];
+    }
+
+    uint8_t green(uint8_t v) const {
+        return table_[1][v];
+    }
+
+    uint8_t blue(uint8_t v) const {
+        return table_[2][v];
+    }
+
+private:
+    uint8_t table_[3][256];
+};
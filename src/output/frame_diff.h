@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Change detection in front of MatrixDriver::flipBuffer(). It keeps a copy of the last frame sent
+// to the panel and reports whether a new frame differs from it, so unchanged frames can skip
+// the copy to the canvas and the SwapOnVSync altogether. A straight memcmp over 8 KiB is cheaper
+// than hashing and cannot produce false matches.
+class FrameDiff {
+public:
+    FrameDiff(int width, int height)
+        : width_(width), height_(height), last_(width * height * 4, 0) {}
+
+    // Returns true (and remembers the frame) if it has to be sent, false if the panel already
+    // shows exactly this image.
+    bool changed(const uint8_t* rgba, int stride) {
+        const size_t rowBytes = width_ * 4;
+        bool differs = !hasFrame_;
+        for (int y = 0; y < height_ && !differs; y++) {
+            differs = std::memcmp(last_.data() + y * rowBytes, rgba + y * stride, rowBytes) != 0;
+        }
+        if (!differs) {
+            skippedFrames_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        for (int y = 0; y < height_; y++) {
+            std::memcpy(last_.data() + y * rowBytes, rgba + y * stride, rowBytes);
+        }
+        hasFrame_ = true;
+        sentFrames_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Forces the next frame through, e.g. after something else touched the panel
+    void invalidate() {
+        hasFrame_ = false;
+    }
+
+    // May be read from other threads than the one calling changed()
+    uint64_t skippedFrames() const {
+        return skippedFrames_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t sentFrames() const {
+        return sentFrames_.load(std::memory_order_relaxed);
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<uint8_t> last_;
+    bool hasFrame_ = false;
+    std::atomic<uint64_t> skippedFrames_{0};
+    std::atomic<uint64_t> sentFrames_{0};
+};
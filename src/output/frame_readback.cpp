@@ -0,0 +1,69 @@
+#include "output/frame_readback.h"
+#include "rlgl.h"
+
+#include <cstring>
+
+#if defined(LED_CLOCK_ASYNC_READBACK)
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#else
+#include <GLES2/gl2.h>
+#endif
+
+FrameReadback::FrameReadback(int width, int height)
+    : width_(width), height_(height), pixels_(width * height * 4, 0) {
+#if defined(LED_CLOCK_ASYNC_READBACK)
+    glGenBuffers(kRingSize, pbos_);
+    for (int i = 0; i < kRingSize; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, pixels_.size(), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    async_ = true;
+#endif
+}
+
+FrameReadback::~FrameReadback() {
+#if defined(LED_CLOCK_ASYNC_READBACK)
+    glDeleteBuffers(kRingSize, pbos_);
+#endif
+}
+
+const uint8_t* FrameReadback::read(const RenderTexture2D &target) {
+    // Make sure everything raylib batched for the target has been submitted
+    rlDrawRenderBatchActive();
+    rlEnableFramebuffer(target.id);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+#if defined(LED_CLOCK_ASYNC_READBACK)
+    int writeSlot = frameIndex_ % kRingSize;
+    // The very first frame has nothing in flight yet, so it maps the read it just queued
+    int readSlot = (frameIndex_ == 0) ? writeSlot : (frameIndex_ + 1) % kRingSize;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[writeSlot]);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[readSlot]);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels_.size(), GL_MAP_READ_BIT);
+    if (mapped != nullptr) {
+        std::memcpy(pixels_.data(), mapped, pixels_.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#else
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+#endif
+
+    rlDisableFramebuffer();
+    frameIndex_++;
+    return pixels_.data();
+}
+
+int FrameReadback::stride() const {
+    return width_ * 4;
+}
+
+bool FrameReadback::isAsync() const {
+    return async_;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <vector>
+
+// Readback stage: copies the finished 64x32 render texture into CPU memory for the matrix
+// driver. It sits between EndDrawing() and MatrixDriver::writeFrame()/flipBuffer().
+//
+// The stage owns its buffers for the lifetime of the program, so nothing is allocated per frame.
+// On desktop GL the read goes through a ring of pixel buffer objects: the read of frame N is
+// queued while frame N-1 (queued one frame earlier) is mapped, so the copy overlaps the next
+// render instead of stalling on it. The panel therefore trails the window by one frame.
+// GLES2 (the Pi) has no PBOs, so there it is a synchronous glReadPixels into the persistent buffer.
+//
+// Rows are returned bottom-up as RGBA8, the way GL stores render textures.
+class FrameReadback {
+public:
+    FrameReadback(int width, int height);
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback &) = delete;
+    FrameReadback &operator=(const FrameReadback &) = delete;
+
+    // Must be called with the GL context current and outside of any texture mode. The returned
+    // pointer stays valid until the next call.
+    const uint8_t* read(const RenderTexture2D &target);
+
+    int stride() const;
+    bool isAsync() const;
+
+private:
+    static const int kRingSize = 2;
+
+    int width_;
+    int height_;
+    std::vector<uint8_t> pixels_;
+    unsigned int pbos_[kRingSize] = {};
+    uint64_t frameIndex_ = 0;
+    bool async_ = false;
+};
@@ -0,0 +1,180 @@
+#include "output/frame_recording.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void putU16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back(value & 0xff);
+    out.push_back(value >> 8);
+}
+
+void writeLE(std::ofstream &file, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        file.put((char)((value >> (i * 8)) & 0xff));
+    }
+}
+
+bool readLE(std::ifstream &file, uint64_t &value, int bytes) {
+    value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int c = file.get();
+        if (c == EOF) {
+            return false;
+        }
+        value |= (uint64_t)(c & 0xff) << (i * 8);
+    }
+    return true;
+}
+
+}  // namespace
+
+FrameRecorder::FrameRecorder(const std::string &path, int width, int height)
+    : file_(path, std::ios::binary | std::ios::trunc)
+    , width_(width)
+    , height_(height)
+    , start_(std::chrono::steady_clock::now())
+    , previous_(width * height * 3, 0) {
+    // Delta encoding gives up once it is no smaller than a raw frame, so it stays under 2x raw
+    delta_.reserve(width * height * 3 * 2 + 4);
+    file_.write(frame_recording::kMagic, sizeof(frame_recording::kMagic));
+    writeLE(file_, frame_recording::kVersion, 2);
+    writeLE(file_, width, 2);
+    writeLE(file_, height, 2);
+    file_.flush();
+}
+
+bool FrameRecorder::isOpen() const {
+    return file_.good();
+}
+
+void FrameRecorder::writeFrame(const uint8_t* rgb) {
+    const int pixelCount = width_ * height_;
+    const size_t rawSize = pixelCount * 3;
+
+    // Encode runs of changed pixels against the previous frame
+    delta_.clear();
+    int pixel = 0;
+    while (hasPrevious_ && pixel < pixelCount && delta_.size() < rawSize) {
+        int keep = 0;
+        while (pixel < pixelCount && keep < 0xffff
+               && std::memcmp(rgb + pixel * 3, previous_.data() + pixel * 3, 3) == 0) {
+            keep++;
+            pixel++;
+        }
+        int changed = 0;
+        while (pixel + changed < pixelCount && changed < 0xffff
+               && std::memcmp(rgb + (pixel + changed) * 3, previous_.data() + (pixel + changed) * 3, 3) != 0) {
+            changed++;
+        }
+        if (changed == 0 && pixel >= pixelCount) {
+            break;
+        }
+        putU16(delta_, keep);
+        putU16(delta_, changed);
+        delta_.insert(delta_.end(), rgb + pixel * 3, rgb + (pixel + changed) * 3);
+        pixel += changed;
+    }
+
+    bool useDelta = hasPrevious_ && delta_.size() < rawSize;
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    writeLE(file_, micros, 8);
+    file_.put(useDelta ? frame_recording::kEncodingDelta : frame_recording::kEncodingRaw);
+    if (useDelta) {
+        writeLE(file_, delta_.size(), 4);
+        file_.write((const char*)delta_.data(), delta_.size());
+    } else {
+        writeLE(file_, rawSize, 4);
+        file_.write((const char*)rgb, rawSize);
+    }
+    // Flush every frame so a crash still leaves a usable recording
+    file_.flush();
+
+    std::memcpy(previous_.data(), rgb, rawSize);
+    hasPrevious_ = true;
+    framesWritten_++;
+}
+
+uint64_t FrameRecorder::framesWritten() const {
+    return framesWritten_;
+}
+
+FrameRecordingReader::FrameRecordingReader(const std::string &path)
+    : file_(path, std::ios::binary) {
+    char magic[sizeof(frame_recording::kMagic)];
+    uint64_t version = 0;
+    uint64_t width = 0;
+    uint64_t height = 0;
+    if (!file_.read(magic, sizeof(magic))
+        || std::memcmp(magic, frame_recording::kMagic, sizeof(magic)) != 0
+        || !readLE(file_, version, 2) || version != frame_recording::kVersion
+        || !readLE(file_, width, 2) || !readLE(file_, height, 2)) {
+        return;
+    }
+    width_ = (int)width;
+    height_ = (int)height;
+    frame_.assign(width_ * height_ * 3, 0);
+    valid_ = true;
+}
+
+bool FrameRecordingReader::isOpen() const {
+    return valid_;
+}
+
+int FrameRecordingReader::width() const {
+    return width_;
+}
+
+int FrameRecordingReader::height() const {
+    return height_;
+}
+
+bool FrameRecordingReader::readFrame(uint64_t &timestampMicros) {
+    if (!valid_) {
+        return false;
+    }
+    uint64_t size = 0;
+    int encoding = EOF;
+    if (!readLE(file_, timestampMicros, 8) || (encoding = file_.get()) == EOF
+        || !readLE(file_, size, 4) || size > frame_.size() * 2) {
+        return false;
+    }
+    payload_.resize(size);
+    if (!file_.read((char*)payload_.data(), size)) {
+        return false;
+    }
+
+    if (encoding == frame_recording::kEncodingRaw) {
+        if (size != frame_.size()) {
+            return false;
+        }
+        std::memcpy(frame_.data(), payload_.data(), size);
+        return true;
+    }
+    if (encoding != frame_recording::kEncodingDelta) {
+        return false;
+    }
+
+    size_t offset = 0;
+    size_t pixel = 0;
+    const size_t pixelCount = frame_.size() / 3;
+    while (offset + 4 <= size) {
+        size_t keep = payload_[offset] | (payload_[offset + 1] << 8);
+        size_t changed = payload_[offset + 2] | (payload_[offset + 3] << 8);
+        offset += 4;
+        pixel += keep;
+        if (pixel + changed > pixelCount || offset + changed * 3 > size) {
+            return false;
+        }
+        std::memcpy(frame_.data() + pixel * 3, payload_.data() + offset, changed * 3);
+        offset += changed * 3;
+        pixel += changed;
+    }
+    return offset == size;
+}
+
+const uint8_t* FrameRecordingReader::frame() const {
+    return frame_.data();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Compact recording of the frames sent to the matrix, written as a stream so a recording can be
+// cut short at any point. Layout (all integers little-endian):
+//
+//   header:  "LMCR", u16 version, u16 width, u16 height
+//   frame:   u64 microseconds since the recording started, u8 encoding, u32 payload size, payload
+//
+// The payload is either the raw top-down RGB frame (kEncodingRaw) or, whenever it is smaller, a
+// delta against the previous frame (kEncodingDelta): a list of runs, each made of u16 pixels to
+// keep, u16 pixels that changed and the RGB values of those changed pixels.
+namespace frame_recording {
+
+const char kMagic[4] = {'L', 'M', 'C', 'R'};
+const uint16_t kVersion = 1;
+const uint8_t kEncodingRaw = 0;
+const uint8_t kEncodingDelta = 1;
+
+}  // namespace frame_recording
+
+class FrameRecorder {
+public:
+    FrameRecorder(const std::string &path, int width, int height);
+
+    bool isOpen() const;
+
+    // `rgb` is a top-down width x height frame, 3 bytes per pixel
+    void writeFrame(const uint8_t* rgb);
+
+    uint64_t framesWritten() const;
+
+private:
+    std::ofstream file_;
+    int width_;
+    int height_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<uint8_t> previous_;
+    std::vector<uint8_t> delta_;
+    bool hasPrevious_ = false;
+    uint64_t framesWritten_ = 0;
+};
+
+class FrameRecordingReader {
+public:
+    explicit FrameRecordingReader(const std::string &path);
+
+    bool isOpen() const;
+    int width() const;
+    int height() const;
+
+    // Decodes the next frame; returns false at the end of the recording or on a corrupt frame
+    bool readFrame(uint64_t &timestampMicros);
+
+    // The last decoded frame, top-down RGB
+    const uint8_t* frame() const;
+
+private:
+    std::ifstream file_;
+    bool valid_ = false;
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<uint8_t> frame_;
+    std::vector<uint8_t> payload_;
+};
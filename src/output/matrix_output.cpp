@@ -0,0 +1,179 @@
+#include "output/matrix_output.h"
+#include "metrics/process_uptime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Time for a fade across the whole brightness range; smaller changes take proportionally less
+const float kFadeSeconds = 1.0f;
+// How often a running fade steps while no new frames arrive
+const std::chrono::milliseconds kFadeStepInterval(20);
+// Largest single fade step. The first step of a fade measures from the last frame sent, which can
+// be long ago when the clock is idle; without a cap the fade would jump straight to the target.
+const float kMaxFadeStepSeconds = 0.1f;
+
+}  // namespace
+
+MatrixOutput::MatrixOutput(MatrixDriver &driver, int width, int height, FrameTimings* timings)
+    : driver_(driver)
+    , timings_(timings)
+    , width_(width)
+    , height_(height)
+    , frames_(Frame{std::vector<uint8_t>(width * height * 4, 0), false})
+    , frameDiff_(width, height) {}
+
+MatrixOutput::~MatrixOutput() {
+    stop();
+}
+
+void MatrixOutput::setCalibration(const ColorCalibration &calibration) {
+    calibration_ = calibration;
+    lut_.build(brightness_, calibration_);
+}
+
+void MatrixOutput::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    worker_ = std::thread([this]() {
+        run();
+    });
+}
+
+void MatrixOutput::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    wakeWorker();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void MatrixOutput::submit(const uint8_t* rgba, int stride, bool flipY) {
+    Frame &frame = frames_.writeBuffer();
+    const int rowBytes = width_ * 4;
+    for (int y = 0; y < height_; y++) {
+        std::memcpy(frame.pixels.data() + y * rowBytes, rgba + y * stride, rowBytes);
+    }
+    frame.flipY = flipY;
+    if (!frames_.publish()) {
+        droppedFrames_++;
+    }
+
+    framePending_.store(true, std::memory_order_release);
+    wakeWorker();
+}
+
+void MatrixOutput::setBrightness(float level) {
+    if (targetBrightness_.exchange(level, std::memory_order_relaxed) != level) {
+        wakeWorker();
+    }
+}
+
+void MatrixOutput::wakeWorker() {
+    // Passing through the mutex orders the notification after the output thread's predicate
+    // check, so it cannot slip in just before the thread blocks and be lost. The output thread
+    // only holds the mutex around that check, never while it writes to the panel.
+    { std::lock_guard<std::mutex> lock(wakeMutex_); }
+    wake_.notify_one();
+}
+
+bool MatrixOutput::fading() const {
+    // Before the first frame there is nothing to fade; the level is applied to that frame as is
+    return sentFrames_ > 0 && brightness_ != targetBrightness_.load(std::memory_order_relaxed);
+}
+
+bool MatrixOutput::updateBrightness() {
+    auto now = std::chrono::steady_clock::now();
+    float elapsed = std::min(std::chrono::duration<float>(now - lastFadeStep_).count(), kMaxFadeStepSeconds);
+    float step = elapsed / kFadeSeconds;
+    lastFadeStep_ = now;
+
+    float target = targetBrightness_.load(std::memory_order_relaxed);
+    if (brightness_ == target) {
+        return false;
+    }
+    // Nothing is on the panel yet, so there is nothing to fade from
+    if (sentFrames_ == 0 || std::fabs(target - brightness_) <= step) {
+        brightness_ = target;
+    } else {
+        brightness_ += target > brightness_ ? step : -step;
+    }
+    lut_.build(brightness_, calibration_);
+    return true;
+}
+
+void MatrixOutput::run() {
+    lastFadeStep_ = std::chrono::steady_clock::now();
+    while (running_) {
+        {
+            // Sleeps until a frame or a new brightness arrives; only a running fade needs the
+            // thread to wake up on its own, to keep stepping it
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            auto woken = [this]() {
+                return framePending_.load(std::memory_order_acquire) || !running_;
+            };
+            if (fading()) {
+                wake_.wait_for(lock, kFadeStepInterval, woken);
+            } else {
+                wake_.wait(lock, [&]() { return woken() || fading(); });
+            }
+        }
+        framePending_.store(false, std::memory_order_relaxed);
+
+        bool fresh = frames_.acquire();
+        if (!fresh && sentFrames_ == 0) {
+            continue;
+        }
+        // While a fade runs, the timed wait above keeps stepping it and re-sending the last frame
+        bool lutChanged = updateBrightness();
+        if (!fresh && !lutChanged) {
+            continue;
+        }
+        if (lutChanged) {
+            frameDiff_.invalidate();
+        }
+        const Frame &frame = frames_.readBuffer();
+        if (!frameDiff_.changed(frame.pixels.data(), width_ * 4)) {
+            continue;
+        }
+        auto writeStart = std::chrono::steady_clock::now();
+        driver_.writeFrame(frame.pixels.data(), width_ * 4, frame.flipY, lut_);
+        auto flipStart = std::chrono::steady_clock::now();
+        driver_.flipBuffer();
+        if (timings_ != nullptr) {
+            timings_->record(FrameStage::MatrixWrite, flipStart - writeStart);
+            timings_->record(FrameStage::FlipBuffer, std::chrono::steady_clock::now() - flipStart);
+        }
+        if (sentFrames_ == 0) {
+            std::chrono::microseconds uptime;
+            if (processUptime(uptime)) {
+                startupMicros_.store(uptime.count(), std::memory_order_relaxed);
+                std::cout << "First frame on the panel " << uptime.count() / 1000 << " ms after process start" << std::endl;
+            }
+        }
+        sentFrames_++;
+    }
+}
+
+uint64_t MatrixOutput::sentFrames() const {
+    return sentFrames_;
+}
+
+int64_t MatrixOutput::startupMicros() const {
+    return startupMicros_.load(std::memory_order_relaxed);
+}
+
+uint64_t MatrixOutput::skippedFrames() const {
+    // FrameDiff does the counting, since it is what decides a frame is unchanged
+    return frameDiff_.skippedFrames();
+}
+
+uint64_t MatrixOutput::droppedFrames() const {
+    return droppedFrames_;
+}
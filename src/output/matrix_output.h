@@ -0,0 +1,89 @@
+#pragma once
+
+#include "matrix_driver.h"
+#include "metrics/frame_timing.h"
+#include "output/color_lut.h"
+#include "output/frame_diff.h"
+#include "output/triple_buffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Dedicated thread that pushes finished frames to the matrix. The render loop hands frames over
+// through a lock-free TripleBuffer and never waits on the panel; the output thread drops frames
+// that are identical to what the panel already shows (FrameDiff) and blocks in SwapOnVSync on its
+// own time. If the panel falls behind, the newest frame wins and the ones in between are dropped.
+// Waking the output thread does take a mutex, but only for as long as that thread holds it to
+// check whether there is work, never while it talks to the panel.
+// Brightness is applied here too, through a ColorLut on the copy to the matrix, and changes of
+// level fade in over a few hundred milliseconds.
+class MatrixOutput {
+public:
+    // `timings` (optional) receives the MatrixWrite and FlipBuffer stages
+    MatrixOutput(MatrixDriver &driver, int width, int height, FrameTimings* timings = nullptr);
+    ~MatrixOutput();
+
+    MatrixOutput(const MatrixOutput &) = delete;
+    MatrixOutput &operator=(const MatrixOutput &) = delete;
+
+    // Must be called before start()
+    void setCalibration(const ColorCalibration &calibration);
+
+    void start();
+    void stop();
+
+    // Called from the render thread. 1.0 is full brightness; the panel fades to a new level.
+    void setBrightness(float level);
+
+    // Called from the render thread. Copies the frame into the TripleBuffer and wakes the output
+    // thread, passing briefly through the wake mutex (see wakeWorker()); never waits on the panel.
+    void submit(const uint8_t* rgba, int stride, bool flipY);
+
+    uint64_t sentFrames() const;
+    uint64_t skippedFrames() const;
+    uint64_t droppedFrames() const;
+    // Microseconds from process start to the first frame on the panel; -1 until it is shown (or
+    // if /proc is missing)
+    int64_t startupMicros() const;
+
+private:
+    struct Frame {
+        std::vector<uint8_t> pixels;
+        bool flipY = false;
+    };
+
+    void run();
+    // Steps the fade towards the requested level; true if the LUT was rebuilt
+    bool updateBrightness();
+    // Output thread only: the panel shows a level other than the requested one
+    bool fading() const;
+    void wakeWorker();
+
+    MatrixDriver &driver_;
+    FrameTimings* timings_;
+    int width_;
+    int height_;
+    TripleBuffer<Frame> frames_;
+    FrameDiff frameDiff_;
+
+    ColorCalibration calibration_;
+    ColorLut lut_;
+    std::atomic<float> targetBrightness_{1.0f};
+    float brightness_ = 1.0f;
+    std::chrono::steady_clock::time_point lastFadeStep_;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> framePending_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+
+    std::atomic<uint64_t> sentFrames_{0};
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<int64_t> startupMicros_{-1};
+};
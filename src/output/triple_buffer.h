@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer triple buffer. The producer always has a slot to
+// write into and the consumer always has a slot to read from; the third slot is handed between
+// them with one atomic exchange. Publishing never waits for the consumer: if the previous frame
+// was not picked up yet it is simply replaced, so late frames are dropped rather than queued.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T &initial) : slots_{initial, initial, initial} {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Producer side: the slot to fill before calling publish()
+    T &writeBuffer() {
+        return slots_[back_];
+    }
+
+    // Producer side: makes the write buffer the newest frame. Returns false if this replaced a
+    // frame the consumer never saw.
+    bool publish() {
+        uint8_t previous = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+        return (previous & kFresh) == 0;
+    }
+
+    // Consumer side: swaps in the newest frame if there is one. Returns false if nothing new
+    // was published since the last call, in which case readBuffer() is unchanged.
+    bool acquire() {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & kIndexMask;
+        return true;
+    }
+
+    // Consumer side: the frame returned by the last successful acquire()
+    const T &readBuffer() const {
+        return slots_[front_];
+    }
+
+private:
+    static const uint8_t kIndexMask = 0x03;
+    static const uint8_t kFresh = 0x04;
+
+    T slots_[3];
+    uint8_t back_ = 0;
+    std::atomic<uint8_t> middle_{1};
+    uint8_t front_ = 2;
+};
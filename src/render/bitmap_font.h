@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+
+// Built-in font for the CPU rasterizer, which cannot use raylib's default font without a GL
+// context. Glyphs are up to 5 pixels wide with a 7 pixel body and 2 descender rows, matching the
+// metrics of raylib's 10 px default font closely enough that the clock layout is unchanged.
+// Row bits are left-aligned to the glyph width: the most significant used bit is the leftmost column.
+namespace bitmap_font {
+
+const int kGlyphRows = 9;
+const int kBaseSize = 10;
+
+struct Glyph {
+    uint8_t width;
+    uint8_t rows[kGlyphRows];
+};
+
+// Printable ASCII, starting at ' '
+const Glyph kGlyphs[] = {
+    {3, {0b000, 0b000, 0b000, 0b000, 0b000, 0b000, 0b000, 0b000, 0b000}},  // space
+    {1, {0b1, 0b1, 0b1, 0b1, 0b1, 0b0, 0b1, 0b0, 0b0}},  // !
+    {3, {0b101, 0b101, 0b000, 0b000, 0b000, 0b000, 0b000, 0b000, 0b000}},  // "
+    {5, {0b01010, 0b01010, 0b11111, 0b01010, 0b11111, 0b01010, 0b01010, 0b00000, 0b00000}},  // #
+    {5, {0b00100, 0b01111, 0b10100, 0b01110, 0b00101, 0b11110, 0b00100, 0b00000, 0b00000}},  // $
+    {5, {0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011, 0b00000, 0b00000}},  // %
+    {5, {0b01100, 0b10010, 0b10100, 0b01000, 0b10101, 0b10010, 0b01101, 0b00000, 0b00000}},  // &
+    {1, {0b1, 0b1, 0b0, 0b0, 0b0, 0b0, 0b0, 0b0, 0b0}},  // '
+    {2, {0b01, 0b10, 0b10, 0b10, 0b10, 0b10, 0b01, 0b00, 0b00}},  // (
+    {2, {0b10, 0b01, 0b01, 0b01, 0b01, 0b01, 0b10, 0b00, 0b00}},  // )
+    {5, {0b00000, 0b00100, 0b10101, 0b01110, 0b10101, 0b00100, 0b00000, 0b00000, 0b00000}},  // *
+    {5, {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000, 0b00000, 0b00000}},  // +
+    {2, {0b00, 0b00, 0b00, 0b00, 0b00, 0b01, 0b01, 0b10, 0b00}},  // ,
+    {4, {0b0000, 0b0000, 0b0000, 0b1111, 0b0000, 0b0000, 0b0000, 0b0000, 0b0000}},  // -
+    {1, {0b0, 0b0, 0b0, 0b0, 0b0, 0b0, 0b1, 0b0, 0b0}},  // .
+    {5, {0b00001, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b10000, 0b00000, 0b00000}},  // /
+    {5, {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110, 0b00000, 0b00000}},  // 0
+    {3, {0b010, 0b110, 0b010, 0b010, 0b010, 0b010, 0b111, 0b000, 0b000}},  // 1
+    {5, {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111, 0b00000, 0b00000}},  // 2
+    {5, {0b11110, 0b00001, 0b00001, 0b01110, 0b00001, 0b00001, 0b11110, 0b00000, 0b00000}},  // 3
+    {5, {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010, 0b00000, 0b00000}},  // 4
+    {5, {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110, 0b00000, 0b00000}},  // 5
+    {5, {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110, 0b00000, 0b00000}},  // 6
+    {5, {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00000, 0b00000}},  // 7
+    {5, {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110, 0b00000, 0b00000}},  // 8
+    {5, {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100, 0b00000, 0b00000}},  // 9
+    {1, {0b0, 0b0, 0b1, 0b0, 0b0, 0b1, 0b0, 0b0, 0b0}},  // :
+    {2, {0b00, 0b00, 0b01, 0b00, 0b00, 0b01, 0b01, 0b10, 0b00}},  // ;
+    {4, {0b0001, 0b0010, 0b0100, 0b1000, 0b0100, 0b0010, 0b0001, 0b0000, 0b0000}},  // <
+    {4, {0b0000, 0b0000, 0b1111, 0b0000, 0b1111, 0b0000, 0b0000, 0b0000, 0b0000}},  // =
+    {4, {0b1000, 0b0100, 0b0010, 0b0001, 0b0010, 0b0100, 0b1000, 0b0000, 0b0000}},  // >
+    {5, {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b00000, 0b00100, 0b00000, 0b00000}},  // ?
+    {5, {0b01110, 0b10001, 0b10111, 0b10101, 0b10111, 0b10000, 0b01111, 0b00000, 0b00000}},  // @
+    {5, {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001, 0b00000, 0b00000}},  // A
+    {5, {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110, 0b00000, 0b00000}},  // B
+    {5, {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110, 0b00000, 0b00000}},  // C
+    {5, {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110, 0b00000, 0b00000}},  // D
+    {5, {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111, 0b00000, 0b00000}},  // E
+    {5, {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000, 0b00000, 0b00000}},  // F
+    {5, {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111, 0b00000, 0b00000}},  // G
+    {5, {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001, 0b00000, 0b00000}},  // H
+    {3, {0b111, 0b010, 0b010, 0b010, 0b010, 0b010, 0b111, 0b000, 0b000}},  // I
+    {5, {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100, 0b00000, 0b00000}},  // J
+    {5, {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001, 0b00000, 0b00000}},  // K
+    {5, {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111, 0b00000, 0b00000}},  // L
+    {5, {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001, 0b00000, 0b00000}},  // M
+    {5, {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001, 0b00000, 0b00000}},  // N
+    {5, {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000, 0b00000}},  // O
+    {5, {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000, 0b00000, 0b00000}},  // P
+    {5, {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101, 0b00000, 0b00000}},  // Q
+    {5, {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001, 0b00000, 0b00000}},  // R
+    {5, {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110, 0b00000, 0b00000}},  // S
+    {5, {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00000}},  // T
+    {5, {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000, 0b00000}},  // U
+    {5, {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00000, 0b00000}},  // V
+    {5, {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010, 0b00000, 0b00000}},  // W
+    {5, {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001, 0b00000, 0b00000}},  // X
+    {5, {0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00000}},  // Y
+    {5, {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111, 0b00000, 0b00000}},  // Z
+    {2, {0b11, 0b10, 0b10, 0b10, 0b10, 0b10, 0b11, 0b00, 0b00}},  // [
+    {5, {0b10000, 0b10000, 0b01000, 0b00100, 0b00010, 0b00001, 0b00001, 0b00000, 0b00000}},  // backslash
+    {2, {0b11, 0b01, 0b01, 0b01, 0b01, 0b01, 0b11, 0b00, 0b00}},  // ]
+    {5, {0b00100, 0b01010, 0b10001, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000}},  // ^
+    {5, {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000}},  // _
+    {2, {0b10, 0b01, 0b00, 0b00, 0b00, 0b00, 0b00, 0b00, 0b00}},  // `
+    {4, {0b0000, 0b0000, 0b0111, 0b1001, 0b1001, 0b1001, 0b0111, 0b0000, 0b0000}},  // a
+    {4, {0b1000, 0b1000, 0b1110, 0b1001, 0b1001, 0b1001, 0b1110, 0b0000, 0b0000}},  // b
+    {4, {0b0000, 0b0000, 0b0111, 0b1000, 0b1000, 0b1000, 0b0111, 0b0000, 0b0000}},  // c
+    {4, {0b0001, 0b0001, 0b0111, 0b1001, 0b1001, 0b1001, 0b0111, 0b0000, 0b0000}},  // d
+    {4, {0b0000, 0b0000, 0b0110, 0b1001, 0b1111, 0b1000, 0b0111, 0b0000, 0b0000}},  // e
+    {3, {0b001, 0b010, 0b111, 0b010, 0b010, 0b010, 0b010, 0b000, 0b000}},  // f
+    {4, {0b0000, 0b0000, 0b0111, 0b1001, 0b1001, 0b1001, 0b0111, 0b0001, 0b1110}},  // g
+    {4, {0b1000, 0b1000, 0b1110, 0b1001, 0b1001, 0b1001, 0b1001, 0b0000, 0b0000}},  // h
+    {1, {0b1, 0b0, 0b1, 0b1, 0b1, 0b1, 0b1, 0b0, 0b0}},  // i
+    {2, {0b01, 0b00, 0b01, 0b01, 0b01, 0b01, 0b01, 0b01, 0b10}},  // j
+    {4, {0b1000, 0b1000, 0b1001, 0b1010, 0b1100, 0b1010, 0b1001, 0b0000, 0b0000}},  // k
+    {1, {0b1, 0b1, 0b1, 0b1, 0b1, 0b1, 0b1, 0b0, 0b0}},  // l
+    {5, {0b00000, 0b00000, 0b11110, 0b10101, 0b10101, 0b10101, 0b10101, 0b00000, 0b00000}},  // m
+    {4, {0b0000, 0b0000, 0b1110, 0b1001, 0b1001, 0b1001, 0b1001, 0b0000, 0b0000}},  // n
+    {4, {0b0000, 0b0000, 0b0110, 0b1001, 0b1001, 0b1001, 0b0110, 0b0000, 0b0000}},  // o
+    {4, {0b0000, 0b0000, 0b1110, 0b1001, 0b1001, 0b1001, 0b1110, 0b1000, 0b1000}},  // p
+    {4, {0b0000, 0b0000, 0b0111, 0b1001, 0b1001, 0b1001, 0b0111, 0b0001, 0b0001}},  // q
+    {3, {0b000, 0b000, 0b101, 0b110, 0b100, 0b100, 0b100, 0b000, 0b000}},  // r
+    {4, {0b0000, 0b0000, 0b0111, 0b1000, 0b0110, 0b0001, 0b1110, 0b0000, 0b0000}},  // s
+    {3, {0b010, 0b010, 0b111, 0b010, 0b010, 0b010, 0b001, 0b000, 0b000}},  // t
+    {4, {0b0000, 0b0000, 0b1001, 0b1001, 0b1001, 0b1001, 0b0111, 0b0000, 0b0000}},  // u
+    {3, {0b000, 0b000, 0b101, 0b101, 0b101, 0b101, 0b010, 0b000, 0b000}},  // v
+    {5, {0b00000, 0b00000, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010, 0b00000, 0b00000}},  // w
+    {3, {0b000, 0b000, 0b101, 0b101, 0b010, 0b101, 0b101, 0b000, 0b000}},  // x
+    {4, {0b0000, 0b0000, 0b1001, 0b1001, 0b1001, 0b1001, 0b0111, 0b0001, 0b1110}},  // y
+    {4, {0b0000, 0b0000, 0b1111, 0b0001, 0b0010, 0b0100, 0b1111, 0b0000, 0b0000}},  // z
+    {3, {0b001, 0b010, 0b010, 0b100, 0b010, 0b010, 0b001, 0b000, 0b000}},  // {
+    {1, {0b1, 0b1, 0b1, 0b1, 0b1, 0b1, 0b1, 0b0, 0b0}},  // |
+    {3, {0b100, 0b010, 0b010, 0b001, 0b010, 0b010, 0b100, 0b000, 0b000}},  // }
+    {5, {0b00000, 0b00000, 0b01000, 0b10101, 0b00010, 0b00000, 0b00000, 0b00000, 0b00000}},  // ~
+};
+
+inline const Glyph &GlyphFor(char c) {
+    if (c < ' ' || c > '~') {
+        c = '?';
+    }
+    return kGlyphs[c - ' '];
+}
+
+}  // namespace bitmap_font
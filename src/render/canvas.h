@@ -0,0 +1,60 @@
+#pragma once
+
+#include "raylib.h"
+#include "render/pixel_span.h"
+
+// A decoded image ready to be drawn by one backend. The raylib backend keeps it on the GPU, the
+// CPU backend keeps the RGBA8 pixels in `image`.
+struct CanvasTexture {
+    int width = 0;
+    int height = 0;
+    Texture2D texture{};
+    Image image{};
+};
+
+class RenderSurface;
+
+// Drawing interface shared by the clock face and the animations. It mirrors the subset of
+// raylib's immediate-mode API the clock uses, so a scene can be drawn through raylib or
+// rasterized straight into a CPU buffer without changing the drawing code.
+class Canvas {
+public:
+    virtual ~Canvas() = default;
+
+    virtual int Width() const = 0;
+    virtual int Height() const = 0;
+
+    virtual void Clear(Color color) = 0;
+    virtual void DrawPixel(int x, int y, Color color) = 0;
+    virtual void DrawLine(int startX, int startY, int endX, int endY, Color color) = 0;
+    virtual void DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) = 0;
+    virtual void DrawRectangle(int x, int y, int width, int height, Color color) = 0;
+    virtual void DrawCircle(Vector2 center, float radius, Color color) = 0;
+    virtual void DrawText(const char *text, int x, int y, int fontSize, Color color) = 0;
+    virtual int MeasureText(const char *text, int fontSize) = 0;
+    virtual void DrawTexture(const CanvasTexture &texture, int x, int y, Color tint) = 0;
+    // Draws the `source` part of the texture (an atlas entry) with its corner at (x, y)
+    virtual void DrawTextureRec(const CanvasTexture &texture, Rectangle source, int x, int y, Color tint) = 0;
+    // Replaces every pixel, alpha included, with the contents of `source`. The surface has to
+    // come from the same backend, be the same size, and not be the one being drawn into.
+    virtual void CopySurface(const RenderSurface &source) = 0;
+    // Replaces the canvas, alpha included, with a buffer of the same size in one upload or copy
+    virtual void WritePixels(const PixelSpan &pixels) = 0;
+    // Alpha blends the `sourceRec` part of `source` (top-left origin) with its corner at (x, y).
+    // The same backend and nesting rules as CopySurface() apply.
+    virtual void DrawSurfaceRec(const RenderSurface &source, Rectangle sourceRec, int x, int y) = 0;
+
+    // Only BLEND_ALPHA (the default) and BLEND_MULTIPLIED are used by the clock
+    virtual void BeginBlendMode(int mode) = 0;
+    virtual void EndBlendMode() = 0;
+};
+
+// An offscreen image that can be drawn into. Begin() and End() bracket the drawing, like
+// BeginTextureMode()/EndTextureMode(); surfaces cannot be nested.
+class RenderSurface {
+public:
+    virtual ~RenderSurface() = default;
+
+    virtual Canvas &Begin() = 0;
+    virtual void End() = 0;
+};
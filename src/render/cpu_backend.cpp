@@ -0,0 +1,323 @@
+#include "render/cpu_backend.h"
+#include "render/bitmap_font.h"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t closeRequested = 0;
+
+void requestClose(int) {
+    closeRequested = 1;
+}
+
+unsigned char mix(int src, int dst, int alpha) {
+    return (unsigned char)((src * alpha + dst * (255 - alpha) + 127) / 255);
+}
+
+unsigned char multiply(int src, int dst, int alpha) {
+    return (unsigned char)std::min(255, (src * dst + dst * (255 - alpha) + 127) / 255);
+}
+
+}  // namespace
+
+CpuCanvas::CpuCanvas(int width, int height)
+    : width_(width), height_(height), pixels_(width * height, (Color){0, 0, 0, 255}) {}
+
+int CpuCanvas::Width() const {
+    return width_;
+}
+
+int CpuCanvas::Height() const {
+    return height_;
+}
+
+void CpuCanvas::Blend(int x, int y, Color color) {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return;
+    }
+    Color &dst = pixels_[y * width_ + x];
+    if (blendMode_ == BLEND_MULTIPLIED) {
+        dst.r = multiply(color.r, dst.r, color.a);
+        dst.g = multiply(color.g, dst.g, color.a);
+        dst.b = multiply(color.b, dst.b, color.a);
+    } else {
+        dst.r = mix(color.r, dst.r, color.a);
+        dst.g = mix(color.g, dst.g, color.a);
+        dst.b = mix(color.b, dst.b, color.a);
+        dst.a = (unsigned char)(color.a + (dst.a * (255 - color.a) + 127) / 255);
+    }
+}
+
+void CpuCanvas::Clear(Color color) {
+    std::fill(pixels_.begin(), pixels_.end(), color);
+}
+
+void CpuCanvas::DrawPixel(int x, int y, Color color) {
+    Blend(x, y, color);
+}
+
+void CpuCanvas::DrawLine(int startX, int startY, int endX, int endY, Color color) {
+    // Bresenham, leaving out the end point the way GL line rasterization does
+    int dx = std::abs(endX - startX);
+    int dy = -std::abs(endY - startY);
+    int stepX = (startX < endX) ? 1 : -1;
+    int stepY = (startY < endY) ? 1 : -1;
+    int error = dx + dy;
+    int x = startX;
+    int y = startY;
+    while (x != endX || y != endY) {
+        Blend(x, y, color);
+        int error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x += stepX;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y += stepY;
+        }
+    }
+}
+
+void CpuCanvas::DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) {
+    // Fill the pixels whose centers fall inside the quad raylib would draw for the line
+    float dirX = end.x - start.x;
+    float dirY = end.y - start.y;
+    float lengthSq = dirX * dirX + dirY * dirY;
+    if (lengthSq <= 0.0f) {
+        return;
+    }
+    float halfThick = thick / 2.0f;
+    int minX = std::max(0, (int)std::floor(std::min(start.x, end.x) - halfThick));
+    int maxX = std::min(width_ - 1, (int)std::ceil(std::max(start.x, end.x) + halfThick));
+    int minY = std::max(0, (int)std::floor(std::min(start.y, end.y) - halfThick));
+    int maxY = std::min(height_ - 1, (int)std::ceil(std::max(start.y, end.y) + halfThick));
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            float px = x + 0.5f - start.x;
+            float py = y + 0.5f - start.y;
+            float along = (px * dirX + py * dirY) / lengthSq;
+            if (along < 0.0f || along > 1.0f) {
+                continue;
+            }
+            float across = (px * dirY - py * dirX);
+            if (across * across <= halfThick * halfThick * lengthSq) {
+                Blend(x, y, color);
+            }
+        }
+    }
+}
+
+void CpuCanvas::DrawRectangle(int x, int y, int width, int height, Color color) {
+    int minX = std::max(0, x);
+    int maxX = std::min(width_, x + width);
+    int minY = std::max(0, y);
+    int maxY = std::min(height_, y + height);
+    for (int yy = minY; yy < maxY; yy++) {
+        for (int xx = minX; xx < maxX; xx++) {
+            Blend(xx, yy, color);
+        }
+    }
+}
+
+void CpuCanvas::DrawCircle(Vector2 center, float radius, Color color) {
+    int minX = std::max(0, (int)std::floor(center.x - radius));
+    int maxX = std::min(width_ - 1, (int)std::ceil(center.x + radius));
+    int minY = std::max(0, (int)std::floor(center.y - radius));
+    int maxY = std::min(height_ - 1, (int)std::ceil(center.y + radius));
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            float dx = x + 0.5f - center.x;
+            float dy = y + 0.5f - center.y;
+            if (dx * dx + dy * dy <= radius * radius) {
+                Blend(x, y, color);
+            }
+        }
+    }
+}
+
+void CpuCanvas::DrawText(const char *text, int x, int y, int fontSize, Color color) {
+    // Like raylib, sizes below the base size render at the base size
+    int scale = std::max(fontSize, bitmap_font::kBaseSize) / bitmap_font::kBaseSize;
+    int penX = x;
+    for (const char* c = text; *c != '\0'; c++) {
+        const bitmap_font::Glyph &glyph = bitmap_font::GlyphFor(*c);
+        for (int row = 0; row < bitmap_font::kGlyphRows; row++) {
+            for (int col = 0; col < glyph.width; col++) {
+                if (glyph.rows[row] & (1 << (glyph.width - 1 - col))) {
+                    DrawRectangle(penX + col * scale, y + row * scale, scale, scale, color);
+                }
+            }
+        }
+        penX += (glyph.width + 1) * scale;
+    }
+}
+
+int CpuCanvas::MeasureText(const char *text, int fontSize) {
+    int scale = std::max(fontSize, bitmap_font::kBaseSize) / bitmap_font::kBaseSize;
+    int width = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        width += (bitmap_font::GlyphFor(*c).width + 1) * scale;
+    }
+    // No spacing after the last glyph
+    return (width > 0) ? width - scale : 0;
+}
+
+void CpuCanvas::DrawTexture(const CanvasTexture &texture, int x, int y, Color tint) {
+    DrawTextureRec(texture, (Rectangle){0, 0, (float)texture.width, (float)texture.height}, x, y, tint);
+}
+
+void CpuCanvas::DrawTextureRec(const CanvasTexture &texture, Rectangle source, int x, int y, Color tint) {
+    const Color* src = (const Color*)texture.image.data;
+    if (src == nullptr) {
+        return;
+    }
+    int srcX = (int)source.x;
+    int srcY = (int)source.y;
+    int width = std::min((int)source.width, texture.width - srcX);
+    int height = std::min((int)source.height, texture.height - srcY);
+    for (int yy = 0; yy < height; yy++) {
+        for (int xx = 0; xx < width; xx++) {
+            Color texel = src[(srcY + yy) * texture.width + srcX + xx];
+            texel.r = (unsigned char)(texel.r * tint.r / 255);
+            texel.g = (unsigned char)(texel.g * tint.g / 255);
+            texel.b = (unsigned char)(texel.b * tint.b / 255);
+            texel.a = (unsigned char)(texel.a * tint.a / 255);
+            Blend(x + xx, y + yy, texel);
+        }
+    }
+}
+
+void CpuCanvas::CopySurface(const RenderSurface &source) {
+    const CpuCanvas &contents = static_cast<const CpuSurface &>(source).Contents();
+    std::copy(contents.Pixels(), contents.Pixels() + pixels_.size(), pixels_.begin());
+}
+
+void CpuCanvas::WritePixels(const PixelSpan &pixels) {
+    int width = std::min(pixels.width, width_);
+    int height = std::min(pixels.height, height_);
+    for (int y = 0; y < height; y++) {
+        std::copy(pixels.Row(y), pixels.Row(y) + width, pixels_.begin() + y * width_);
+    }
+}
+
+void CpuCanvas::DrawSurfaceRec(const RenderSurface &source, Rectangle sourceRec, int x, int y) {
+    const CpuCanvas &contents = static_cast<const CpuSurface &>(source).Contents();
+    int srcX = (int)sourceRec.x;
+    int srcY = (int)sourceRec.y;
+    int width = std::min((int)sourceRec.width, contents.Width() - srcX);
+    int height = std::min((int)sourceRec.height, contents.Height() - srcY);
+    for (int yy = 0; yy < height; yy++) {
+        const Color* row = contents.Pixels() + (srcY + yy) * contents.Width() + srcX;
+        for (int xx = 0; xx < width; xx++) {
+            // Fully transparent texels are most of a glyph cell
+            if (row[xx].a != 0) {
+                Blend(x + xx, y + yy, row[xx]);
+            }
+        }
+    }
+}
+
+void CpuCanvas::BeginBlendMode(int mode) {
+    blendMode_ = mode;
+}
+
+void CpuCanvas::EndBlendMode() {
+    blendMode_ = BLEND_ALPHA;
+}
+
+Canvas &CpuSurface::Begin() {
+    return canvas_;
+}
+
+void CpuSurface::End() {
+}
+
+CpuBackend::CpuBackend(int width, int height)
+    : width_(width), target_(width, height), frameStart_(std::chrono::steady_clock::now()) {
+    std::cout << "Rendering headless on the CPU" << std::endl;
+    std::signal(SIGINT, requestClose);
+    std::signal(SIGTERM, requestClose);
+}
+
+const char *CpuBackend::Name() const {
+    return "cpu";
+}
+
+bool CpuBackend::ShouldClose() {
+    return closeRequested != 0;
+}
+
+void CpuBackend::SetTargetFps(int fps) {
+    if (fps > 0) {
+        frameDuration_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / fps));
+    } else {
+        frameDuration_ = std::chrono::steady_clock::duration::zero();
+    }
+}
+
+float CpuBackend::FrameTime() {
+    return frameTime_;
+}
+
+bool CpuBackend::IsKeyDown(int key) {
+    return false;
+}
+
+CanvasTexture CpuBackend::LoadTexture(const char *path) {
+    CanvasTexture texture;
+    texture.image = LoadImage(path);
+    ImageFormat(&texture.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    texture.width = texture.image.width;
+    texture.height = texture.image.height;
+    return texture;
+}
+
+CanvasTexture CpuBackend::LoadTextureFromPixels(const uint8_t* rgba, int width, int height) {
+    CanvasTexture texture;
+    texture.image = ImageCopy((Image){(void*)rgba, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8});
+    texture.width = width;
+    texture.height = height;
+    return texture;
+}
+
+std::unique_ptr<RenderSurface> CpuBackend::CreateSurface(int width, int height) {
+    return std::make_unique<CpuSurface>(width, height);
+}
+
+void CpuBackend::BeginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    frameTime_ = std::chrono::duration<float>(now - frameStart_).count();
+    frameStart_ = now;
+}
+
+RenderSurface &CpuBackend::Target() {
+    return target_;
+}
+
+void CpuBackend::EndFrame() {
+    // Paced from the end of the previous frame like raylib, so the first frame after Idle()
+    // does not wait
+    std::this_thread::sleep_until(lastFrameEnd_ + frameDuration_);
+    lastFrameEnd_ = std::chrono::steady_clock::now();
+}
+
+FrameView CpuBackend::ReadFrame() {
+    FrameView frame;
+    frame.pixels = (const uint8_t*)target_.Contents().Pixels();
+    frame.stride = width_ * 4;
+    frame.flipY = false;
+    return frame;
+}
+
+void CpuBackend::Idle(std::chrono::steady_clock::time_point until) {
+    // The signal handlers only set a flag, so a shutdown waits out the current sleep at most
+    std::this_thread::sleep_until(until);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "render/render_backend.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Software rasterizer drawing straight into an RGBA8 buffer. Blending follows raylib's GL
+// state: BLEND_ALPHA is src * a + dst * (1 - a) and BLEND_MULTIPLIED is src * dst + dst * (1 - a).
+class CpuCanvas : public Canvas {
+public:
+    CpuCanvas(int width, int height);
+
+    int Width() const override;
+    int Height() const override;
+
+    void Clear(Color color) override;
+    void DrawPixel(int x, int y, Color color) override;
+    void DrawLine(int startX, int startY, int endX, int endY, Color color) override;
+    void DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) override;
+    void DrawRectangle(int x, int y, int width, int height, Color color) override;
+    void DrawCircle(Vector2 center, float radius, Color color) override;
+    void DrawText(const char *text, int x, int y, int fontSize, Color color) override;
+    int MeasureText(const char *text, int fontSize) override;
+    void DrawTexture(const CanvasTexture &texture, int x, int y, Color tint) override;
+    void DrawTextureRec(const CanvasTexture &texture, Rectangle source, int x, int y, Color tint) override;
+    void CopySurface(const RenderSurface &source) override;
+    void WritePixels(const PixelSpan &pixels) override;
+    void DrawSurfaceRec(const RenderSurface &source, Rectangle sourceRec, int x, int y) override;
+
+    void BeginBlendMode(int mode) override;
+    void EndBlendMode() override;
+
+    const Color* Pixels() const {
+        return pixels_.data();
+    }
+
+private:
+    void Blend(int x, int y, Color color);
+
+    int width_;
+    int height_;
+    int blendMode_ = BLEND_ALPHA;
+    std::vector<Color> pixels_;
+};
+
+class CpuSurface : public RenderSurface {
+public:
+    CpuSurface(int width, int height) : canvas_(width, height) {}
+
+    Canvas &Begin() override;
+    void End() override;
+
+    const CpuCanvas &Contents() const {
+        return canvas_;
+    }
+
+private:
+    CpuCanvas canvas_;
+};
+
+// Headless backend: no window, no GL context. Frames are paced by sleeping and the loop ends on
+// SIGINT/SIGTERM. Textures are decoded with raylib's image loader, which does not need a window.
+class CpuBackend : public RenderBackend {
+public:
+    CpuBackend(int width, int height);
+
+    const char *Name() const override;
+
+    bool ShouldClose() override;
+    void SetTargetFps(int fps) override;
+    float FrameTime() override;
+    bool IsKeyDown(int key) override;
+
+    CanvasTexture LoadTexture(const char *path) override;
+    CanvasTexture LoadTextureFromPixels(const uint8_t* rgba, int width, int height) override;
+    std::unique_ptr<RenderSurface> CreateSurface(int width, int height) override;
+
+    void BeginFrame() override;
+    RenderSurface &Target() override;
+    void EndFrame() override;
+    FrameView ReadFrame() override;
+    void Idle(std::chrono::steady_clock::time_point until) override;
+
+private:
+    int width_;
+    CpuSurface target_;
+    std::chrono::steady_clock::duration frameDuration_{0};
+    std::chrono::steady_clock::time_point frameStart_;
+    std::chrono::steady_clock::time_point lastFrameEnd_;
+    float frameTime_ = 0.0f;
+};
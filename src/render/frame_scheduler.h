@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+// Decides when the main loop has to draw. The clock face only changes on a second boundary or
+// when something it shows changes (weather, dim button, brightness), so between those the loop
+// just polls its inputs and sleeps. While an animation runs it draws every frame instead.
+class FrameScheduler {
+public:
+    // `pollInterval` bounds how long a button press or an animation request can go unnoticed
+    explicit FrameScheduler(std::chrono::milliseconds pollInterval) : pollInterval_(pollInterval) {}
+
+    // Something visible changed; the next shouldDraw() returns true
+    void requestRedraw() {
+        redrawRequested_ = true;
+    }
+
+    // `continuous` is true while an animation is playing; `wallSecond` is the current time_t
+    bool shouldDraw(bool continuous, std::time_t wallSecond) {
+        bool draw = continuous || continuous_ || redrawRequested_ || wallSecond != lastDrawnSecond_;
+        // Leaving continuous mode also redraws, so the clock face replaces the last animation frame
+        continuous_ = continuous;
+        if (draw) {
+            redrawRequested_ = false;
+            lastDrawnSecond_ = wallSecond;
+        }
+        return draw;
+    }
+
+    // When an idle loop should wake up: the next poll, or the next wall clock second if sooner
+    std::chrono::steady_clock::time_point nextWake() const {
+        auto now = std::chrono::steady_clock::now();
+        auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+        auto untilNextSecond = std::chrono::seconds(1) - (sinceEpoch % std::chrono::seconds(1));
+        return now + std::min<std::chrono::steady_clock::duration>(pollInterval_, untilNextSecond);
+    }
+
+private:
+    std::chrono::milliseconds pollInterval_;
+    bool redrawRequested_ = true;
+    bool continuous_ = false;
+    std::time_t lastDrawnSecond_ = 0;
+};
@@ -0,0 +1,71 @@
+#include "render/glyph_atlas.h"
+
+#include <algorithm>
+
+GlyphAtlas::GlyphAtlas(RenderBackend &backend) : backend_(backend) {}
+
+int GlyphAtlas::AddStyle(int fontSize, Color fill, Color outline) {
+    // Both backends draw sizes below 10 px at 10 px, and no glyph is wider than it is tall
+    int size = std::max(fontSize, 10);
+    Sheet sheet;
+    sheet.cellWidth = size + 2;
+    sheet.cellHeight = size + 2;
+    int rows = (kGlyphCount + kColumns - 1) / kColumns;
+    sheet.surface = backend_.CreateSurface(kColumns * sheet.cellWidth, rows * sheet.cellHeight);
+
+    Canvas &canvas = sheet.surface->Begin();
+    canvas.Clear((Color){0, 0, 0, 0});
+    sheet.spacing = canvas.MeasureText("!!", fontSize) - 2 * canvas.MeasureText("!", fontSize);
+    for (int i = 0; i < kGlyphCount; i++) {
+        char glyph[2] = {(char)(kFirstGlyph + i), '\0'};
+        sheet.widths[i] = canvas.MeasureText(glyph, fontSize);
+
+        int x = (i % kColumns) * sheet.cellWidth + 1;
+        int y = (i / kColumns) * sheet.cellHeight + 1;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                canvas.DrawText(glyph, x + dx, y + dy, fontSize, outline);
+            }
+        }
+        canvas.DrawText(glyph, x, y, fontSize, fill);
+    }
+    sheet.surface->End();
+
+    sheets_.push_back(std::move(sheet));
+    return (int)sheets_.size() - 1;
+}
+
+void GlyphAtlas::DrawText(Canvas &canvas, int style, const char *text, int x, int y) const {
+    const Sheet &sheet = sheets_[style];
+    // Neighbouring glyphs are at least `spacing` apart, which keeps each outline off the fill
+    // of the glyph before it
+    int penX = x;
+    for (const char* c = text; *c != '\0'; c++) {
+        int index = GlyphIndex(*c);
+        Rectangle cell = {(float)((index % kColumns) * sheet.cellWidth),
+                          (float)((index / kColumns) * sheet.cellHeight),
+                          (float)(sheet.widths[index] + 2),
+                          (float)sheet.cellHeight};
+        canvas.DrawSurfaceRec(*sheet.surface, cell, penX - 1, y - 1);
+        penX += sheet.widths[index] + sheet.spacing;
+    }
+}
+
+int GlyphAtlas::MeasureText(int style, const char *text) const {
+    const Sheet &sheet = sheets_[style];
+    int width = 0;
+    int count = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        width += sheet.widths[GlyphIndex(*c)];
+        count++;
+    }
+    // No spacing after the last glyph
+    return (count > 0) ? width + (count - 1) * sheet.spacing : 0;
+}
+
+int GlyphAtlas::GlyphIndex(char c) {
+    if (c < kFirstGlyph || c > kLastGlyph) {
+        c = '?';
+    }
+    return c - kFirstGlyph;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "render/render_backend.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Outlined text from pre-rasterized glyphs. Each style (font size, fill and outline color) is
+// drawn once into a sheet holding every printable ASCII character with its 1 px outline baked in,
+// so a string costs one blit per glyph instead of nine DrawText() passes, and measuring it is a
+// sum of cached advances. The result matches drawing the outline at the eight neighbouring
+// offsets and then the fill, as long as both colors are opaque.
+//
+//   int style = atlas.AddStyle(5, WHITE, BLACK);          // outside any Begin()/End()
+//   atlas.DrawText(canvas, style, "12:34", x, y);
+class GlyphAtlas {
+public:
+    explicit GlyphAtlas(RenderBackend &backend);
+
+    GlyphAtlas(const GlyphAtlas &) = delete;
+    GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+    // Rasterizes the sheet for a style and returns its handle. Must not be called inside another
+    // surface's Begin()/End().
+    int AddStyle(int fontSize, Color fill, Color outline);
+
+    // Same placement as Canvas::DrawText(): (x, y) is the top-left of the fill, and the outline
+    // reaches one pixel beyond it
+    void DrawText(Canvas &canvas, int style, const char *text, int x, int y) const;
+    // Width of the fill, like Canvas::MeasureText()
+    int MeasureText(int style, const char *text) const;
+
+private:
+    static const char kFirstGlyph = ' ';
+    static const char kLastGlyph = '~';
+    static const int kGlyphCount = kLastGlyph - kFirstGlyph + 1;
+    static const int kColumns = 16;
+
+    struct Sheet {
+        std::unique_ptr<RenderSurface> surface;
+        int cellWidth = 0;
+        int cellHeight = 0;
+        int spacing = 0;
+        std::array<int, kGlyphCount> widths{};
+    };
+
+    // Characters the sheet lacks are drawn as '?', like raylib does
+    static int GlyphIndex(char c);
+
+    RenderBackend &backend_;
+    std::vector<Sheet> sheets_;
+};
@@ -0,0 +1,43 @@
+#include "render/layer_compositor.h"
+
+#include <algorithm>
+
+LayerCompositor::LayerCompositor(RenderBackend &backend, int width, int height)
+    : backend_(backend), width_(width), height_(height) {}
+
+int LayerCompositor::AddLayer(const char *name, DrawFunction draw) {
+    layers_.push_back({name, std::move(draw), backend_.CreateSurface(width_, height_)});
+    firstDirty_ = std::min(firstDirty_, layers_.size() - 1);
+    return (int)layers_.size() - 1;
+}
+
+void LayerCompositor::Invalidate(int layer) {
+    firstDirty_ = std::min(firstDirty_, (size_t)layer);
+}
+
+void LayerCompositor::InvalidateAll() {
+    firstDirty_ = 0;
+}
+
+void LayerCompositor::Update() {
+    for (size_t i = firstDirty_; i < layers_.size(); i++) {
+        Canvas &canvas = layers_[i].cache->Begin();
+        if (i == 0) {
+            canvas.Clear((Color){0, 0, 0, 255});
+        } else {
+            canvas.CopySurface(*layers_[i - 1].cache);
+        }
+        layers_[i].draw(canvas);
+        layers_[i].cache->End();
+        layersDrawn_++;
+    }
+    firstDirty_ = layers_.size();
+}
+
+const RenderSurface &LayerCompositor::Result() const {
+    return *layers_.back().cache;
+}
+
+uint64_t LayerCompositor::LayersDrawn() const {
+    return layersDrawn_;
+}
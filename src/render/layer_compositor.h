@@ -0,0 +1,56 @@
+#pragma once
+
+#include "render/render_backend.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Caches a scene as a stack of layers so a frame only redraws what changed. Layers are drawn
+// bottom-up in the order they were added, and each keeps a surface holding the scene up to and
+// including itself: a layer is drawn on top of a copy of the layer below. That keeps blending
+// exactly as if everything had been drawn in one pass, at the price that invalidating a layer
+// also redraws every layer above it. Put the layers that change least at the bottom.
+//
+//   compositor.Update();                        // outside any Begin()/End()
+//   canvas.CopySurface(compositor.Result());    // one copy instead of the whole scene
+class LayerCompositor {
+public:
+    using DrawFunction = std::function<void(Canvas &)>;
+
+    LayerCompositor(RenderBackend &backend, int width, int height);
+
+    LayerCompositor(const LayerCompositor &) = delete;
+    LayerCompositor &operator=(const LayerCompositor &) = delete;
+
+    // Returns the layer's index. The bottom layer starts from a cleared surface, so it should
+    // paint every pixel.
+    int AddLayer(const char *name, DrawFunction draw);
+
+    // The layer's inputs changed; it and the layers above it are redrawn on the next Update()
+    void Invalidate(int layer);
+    void InvalidateAll();
+
+    // Redraws the dirty layers. Must not be called inside another surface's Begin()/End().
+    void Update();
+    const RenderSurface &Result() const;
+
+    // Layer redraws since startup, for the log
+    uint64_t LayersDrawn() const;
+
+private:
+    struct Layer {
+        std::string name;
+        DrawFunction draw;
+        std::unique_ptr<RenderSurface> cache;
+    };
+
+    RenderBackend &backend_;
+    int width_;
+    int height_;
+    std::vector<Layer> layers_;
+    // Lowest dirty layer, or layers_.size() if everything is cached
+    size_t firstDirty_ = 0;
+    uint64_t layersDrawn_ = 0;
+};
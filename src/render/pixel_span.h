@@ -0,0 +1,20 @@
+#pragma once
+
+#include "raylib.h"
+
+// A row-major RGBA8 pixel buffer that something else owns. Rows are `stride` pixels apart, so a
+// span can also cover part of a larger buffer.
+struct PixelSpan {
+    Color* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+
+    Color* Row(int y) const {
+        return pixels + y * stride;
+    }
+
+    Color &At(int x, int y) const {
+        return pixels[y * stride + x];
+    }
+};
@@ -0,0 +1,214 @@
+#include "render/raylib_backend.h"
+#include "rlgl.h"
+
+#include <thread>
+
+RaylibCanvas::~RaylibCanvas() {
+    if (pixelTexture_.id != 0) {
+        UnloadTexture(pixelTexture_);
+    }
+}
+
+int RaylibCanvas::Width() const {
+    return width_;
+}
+
+int RaylibCanvas::Height() const {
+    return height_;
+}
+
+void RaylibCanvas::Clear(Color color) {
+    ClearBackground(color);
+}
+
+void RaylibCanvas::DrawPixel(int x, int y, Color color) {
+    ::DrawPixel(x, y, color);
+}
+
+void RaylibCanvas::DrawLine(int startX, int startY, int endX, int endY, Color color) {
+    ::DrawLine(startX, startY, endX, endY, color);
+}
+
+void RaylibCanvas::DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) {
+    ::DrawLineEx(start, end, thick, color);
+}
+
+void RaylibCanvas::DrawRectangle(int x, int y, int width, int height, Color color) {
+    ::DrawRectangle(x, y, width, height, color);
+}
+
+void RaylibCanvas::DrawCircle(Vector2 center, float radius, Color color) {
+    DrawCircleV(center, radius, color);
+}
+
+void RaylibCanvas::DrawText(const char *text, int x, int y, int fontSize, Color color) {
+    ::DrawText(text, x, y, fontSize, color);
+}
+
+int RaylibCanvas::MeasureText(const char *text, int fontSize) {
+    return ::MeasureText(text, fontSize);
+}
+
+void RaylibCanvas::DrawTexture(const CanvasTexture &texture, int x, int y, Color tint) {
+    ::DrawTexture(texture.texture, x, y, tint);
+}
+
+void RaylibCanvas::DrawTextureRec(const CanvasTexture &texture, Rectangle source, int x, int y, Color tint) {
+    ::DrawTextureRec(texture.texture, source, (Vector2){(float)x, (float)y}, tint);
+}
+
+void RaylibCanvas::CopySurface(const RenderSurface &source) {
+    const RenderTexture2D &texture = static_cast<const RaylibSurface &>(source).Texture();
+    // With blending on, the source alpha would be applied a second time
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+    ::DrawTextureRec(texture.texture, (Rectangle){0, 0, (float)width_, (float)-height_}, (Vector2){0, 0}, WHITE);
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+}
+
+void RaylibCanvas::WritePixels(const PixelSpan &pixels) {
+    if (pixelTexture_.id == 0) {
+        Image blank = GenImageColor(width_, height_, BLANK);
+        pixelTexture_ = LoadTextureFromImage(blank);
+        UnloadImage(blank);
+    }
+    // The texture may still be queued from the last call
+    rlDrawRenderBatchActive();
+    if (pixels.stride == pixels.width) {
+        UpdateTexture(pixelTexture_, pixels.pixels);
+    } else {
+        for (int y = 0; y < pixels.height; y++) {
+            UpdateTextureRec(pixelTexture_, (Rectangle){0, (float)y, (float)pixels.width, 1}, pixels.Row(y));
+        }
+    }
+    // Like CopySurface(), a plain copy without blending
+    rlDisableColorBlend();
+    ::DrawTexture(pixelTexture_, 0, 0, WHITE);
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+}
+
+void RaylibCanvas::DrawSurfaceRec(const RenderSurface &source, Rectangle sourceRec, int x, int y) {
+    const RenderTexture2D &texture = static_cast<const RaylibSurface &>(source).Texture();
+    // Render textures are stored bottom-up, so the rows are picked from the other end and flipped
+    Rectangle flipped = {sourceRec.x,
+                         texture.texture.height - sourceRec.y - sourceRec.height,
+                         sourceRec.width,
+                         -sourceRec.height};
+    ::DrawTextureRec(texture.texture, flipped, (Vector2){(float)x, (float)y}, WHITE);
+}
+
+void RaylibCanvas::BeginBlendMode(int mode) {
+    ::BeginBlendMode(mode);
+}
+
+void RaylibCanvas::EndBlendMode() {
+    ::EndBlendMode();
+}
+
+RaylibSurface::RaylibSurface(int width, int height)
+    : texture_(LoadRenderTexture(width, height)), canvas_(width, height) {}
+
+RaylibSurface::~RaylibSurface() {
+    UnloadRenderTexture(texture_);
+}
+
+Canvas &RaylibSurface::Begin() {
+    BeginTextureMode(texture_);
+    return canvas_;
+}
+
+void RaylibSurface::End() {
+    EndTextureMode();
+}
+
+RaylibBackend::RaylibBackend(int width, int height) : width_(width), height_(height) {
+    InitWindow(width * kScreenZoomFactor, height * kScreenZoomFactor, "LED Matrix Clock");
+    target_ = std::make_unique<RaylibSurface>(width, height);
+    readback_ = std::make_unique<FrameReadback>(width, height);
+}
+
+RaylibBackend::~RaylibBackend() {
+    // GL objects have to go before the context does
+    readback_.reset();
+    target_.reset();
+    CloseWindow();
+}
+
+const char *RaylibBackend::Name() const {
+    return "raylib";
+}
+
+bool RaylibBackend::ShouldClose() {
+    return WindowShouldClose();
+}
+
+void RaylibBackend::SetTargetFps(int fps) {
+    SetTargetFPS(fps);
+}
+
+float RaylibBackend::FrameTime() {
+    return GetFrameTime();
+}
+
+bool RaylibBackend::IsKeyDown(int key) {
+    return ::IsKeyDown(key);
+}
+
+CanvasTexture RaylibBackend::LoadTexture(const char *path) {
+    CanvasTexture texture;
+    texture.texture = ::LoadTexture(path);
+    texture.width = texture.texture.width;
+    texture.height = texture.texture.height;
+    return texture;
+}
+
+CanvasTexture RaylibBackend::LoadTextureFromPixels(const uint8_t* rgba, int width, int height) {
+    // The image only borrows the pixels for the upload
+    Image image = {(void*)rgba, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    CanvasTexture texture;
+    texture.texture = ::LoadTextureFromImage(image);
+    texture.width = width;
+    texture.height = height;
+    return texture;
+}
+
+std::unique_ptr<RenderSurface> RaylibBackend::CreateSurface(int width, int height) {
+    return std::make_unique<RaylibSurface>(width, height);
+}
+
+void RaylibBackend::BeginFrame() {
+    BeginDrawing();
+}
+
+RenderSurface &RaylibBackend::Target() {
+    return *target_;
+}
+
+void RaylibBackend::EndFrame() {
+    // Draw a debug UI on the software window
+    ClearBackground((Color){0, 0, 0, 255});
+    DrawTexturePro(target_->Texture().texture,
+                   (Rectangle){0, 0, (float)width_, (float)-height_},
+                   (Rectangle){0, 0, (float)(width_ * kScreenZoomFactor), (float)(height_ * kScreenZoomFactor)},
+                   (Vector2){0, 0},
+                   0.0f,
+                   WHITE);
+    EndDrawing();
+}
+
+FrameView RaylibBackend::ReadFrame() {
+    // Render textures come back with the rows bottom-up
+    FrameView frame;
+    frame.pixels = readback_->read(target_->Texture());
+    frame.stride = readback_->stride();
+    frame.flipY = true;
+    return frame;
+}
+
+void RaylibBackend::Idle(std::chrono::steady_clock::time_point until) {
+    std::this_thread::sleep_until(until);
+    // EndDrawing() normally does this; without it key state and the close button go stale
+    PollInputEvents();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "output/frame_readback.h"
+#include "render/render_backend.h"
+
+#include <memory>
+
+class RaylibCanvas : public Canvas {
+public:
+    RaylibCanvas(int width, int height) : width_(width), height_(height) {}
+    ~RaylibCanvas() override;
+
+    RaylibCanvas(const RaylibCanvas &) = delete;
+    RaylibCanvas &operator=(const RaylibCanvas &) = delete;
+
+    int Width() const override;
+    int Height() const override;
+
+    void Clear(Color color) override;
+    void DrawPixel(int x, int y, Color color) override;
+    void DrawLine(int startX, int startY, int endX, int endY, Color color) override;
+    void DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) override;
+    void DrawRectangle(int x, int y, int width, int height, Color color) override;
+    void DrawCircle(Vector2 center, float radius, Color color) override;
+    void DrawText(const char *text, int x, int y, int fontSize, Color color) override;
+    int MeasureText(const char *text, int fontSize) override;
+    void DrawTexture(const CanvasTexture &texture, int x, int y, Color tint) override;
+    void DrawTextureRec(const CanvasTexture &texture, Rectangle source, int x, int y, Color tint) override;
+    void CopySurface(const RenderSurface &source) override;
+    void WritePixels(const PixelSpan &pixels) override;
+    void DrawSurfaceRec(const RenderSurface &source, Rectangle sourceRec, int x, int y) override;
+
+    void BeginBlendMode(int mode) override;
+    void EndBlendMode() override;
+
+private:
+    int width_;
+    int height_;
+    // Staging texture for WritePixels(), created on first use
+    Texture2D pixelTexture_{};
+};
+
+class RaylibSurface : public RenderSurface {
+public:
+    RaylibSurface(int width, int height);
+    ~RaylibSurface() override;
+
+    RaylibSurface(const RaylibSurface &) = delete;
+    RaylibSurface &operator=(const RaylibSurface &) = delete;
+
+    Canvas &Begin() override;
+    void End() override;
+
+    const RenderTexture2D &Texture() const {
+        return texture_;
+    }
+
+private:
+    RenderTexture2D texture_;
+    RaylibCanvas canvas_;
+};
+
+// Draws through raylib into a render texture, shows it scaled up in a debug window and reads
+// it back from the GPU for the matrix.
+class RaylibBackend : public RenderBackend {
+public:
+    RaylibBackend(int width, int height);
+    ~RaylibBackend() override;
+
+    const char *Name() const override;
+
+    bool ShouldClose() override;
+    void SetTargetFps(int fps) override;
+    float FrameTime() override;
+    bool IsKeyDown(int key) override;
+
+    CanvasTexture LoadTexture(const char *path) override;
+    CanvasTexture LoadTextureFromPixels(const uint8_t* rgba, int width, int height) override;
+    std::unique_ptr<RenderSurface> CreateSurface(int width, int height) override;
+
+    void BeginFrame() override;
+    RenderSurface &Target() override;
+    void EndFrame() override;
+    FrameView ReadFrame() override;
+    void Idle(std::chrono::steady_clock::time_point until) override;
+
+private:
+    static const int kScreenZoomFactor = 10;
+
+    int width_;
+    int height_;
+    std::unique_ptr<RaylibSurface> target_;
+    std::unique_ptr<FrameReadback> readback_;
+};
@@ -0,0 +1,24 @@
+#include "render/render_backend.h"
+#include "render/cpu_backend.h"
+#include "render/raylib_backend.h"
+
+#include <cstring>
+#include <iostream>
+
+std::unique_ptr<RenderBackend> CreateRenderBackend(int argc, char **argv, int width, int height) {
+    const char* prefix = "--renderer=";
+    std::string renderer = "raylib";
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], prefix, std::strlen(prefix)) == 0) {
+            renderer = argv[i] + std::strlen(prefix);
+        }
+    }
+
+    if (renderer == "cpu") {
+        return std::make_unique<CpuBackend>(width, height);
+    }
+    if (renderer != "raylib") {
+        std::cout << "Unknown renderer '" << renderer << "', using raylib" << std::endl;
+    }
+    return std::make_unique<RaylibBackend>(width, height);
+}
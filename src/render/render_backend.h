@@ -0,0 +1,54 @@
+#pragma once
+
+#include "render/canvas.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// The pixels of a finished frame, ready for MatrixDriver::writeFrame()
+struct FrameView {
+    const uint8_t* pixels = nullptr;
+    int stride = 0;
+    bool flipY = false;
+};
+
+// Owns everything needed to draw frames: the 64x32 target, texture loading, frame pacing and
+// input. Each frame follows the same protocol:
+//
+//   backend.BeginFrame();
+//   Canvas &canvas = backend.Target().Begin();  ... draw ...  backend.Target().End();
+//   backend.EndFrame();                          // present, wait for the target frame rate
+//   FrameView frame = backend.ReadFrame();       // hand the pixels to the matrix
+//
+// Between frames that do not need drawing, Idle() sleeps while keeping input serviced.
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual const char *Name() const = 0;
+
+    virtual bool ShouldClose() = 0;
+    virtual void SetTargetFps(int fps) = 0;
+    // Seconds taken by the last frame
+    virtual float FrameTime() = 0;
+    virtual bool IsKeyDown(int key) = 0;
+
+    virtual CanvasTexture LoadTexture(const char *path) = 0;
+    // Copies tightly packed RGBA8 pixels (compiled-in assets) into a texture
+    virtual CanvasTexture LoadTextureFromPixels(const uint8_t* rgba, int width, int height) = 0;
+    virtual std::unique_ptr<RenderSurface> CreateSurface(int width, int height) = 0;
+
+    virtual void BeginFrame() = 0;
+    virtual RenderSurface &Target() = 0;
+    virtual void EndFrame() = 0;
+    virtual FrameView ReadFrame() = 0;
+
+    // Sleeps until `until` without drawing anything, then updates input and close requests
+    virtual void Idle(std::chrono::steady_clock::time_point until) = 0;
+};
+
+// Picks the backend named by `--renderer=raylib|cpu` on the command line (raylib by default).
+// The CPU backend never opens a window or creates a GL context.
+std::unique_ptr<RenderBackend> CreateRenderBackend(int argc, char **argv, int width, int height);
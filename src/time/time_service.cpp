@@ -0,0 +1,70 @@
+#include "time/time_service.h"
+
+namespace {
+
+const long kSecondsPerDay = 24 * 60 * 60;
+
+long utcOffsetAt(std::time_t epochSecond) {
+    std::tm local;
+    localtime_r(&epochSecond, &local);
+    return local.tm_gmtoff;
+}
+
+}  // namespace
+
+CivilTime TimeService::now() {
+    // A vDSO clock read; only at() ever reaches the time zone code, and rarely
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    return at((std::time_t)std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count());
+}
+
+CivilTime TimeService::at(std::time_t epochSecond) {
+    if (epochSecond < validFrom_ || epochSecond >= validUntil_) {
+        recompute(epochSecond);
+    }
+    CivilTime time = day_;
+    time.epochSecond = epochSecond;
+    time.secondOfDay = (int)(epochSecond + day_.utcOffset - dayStartWall_);
+    time.hour = time.secondOfDay / 3600;
+    time.minute = (time.secondOfDay / 60) % 60;
+    time.second = time.secondOfDay % 60;
+    return time;
+}
+
+void TimeService::recompute(std::time_t epochSecond) {
+    recomputations_++;
+    std::tm local;
+    localtime_r(&epochSecond, &local);
+
+    day_.year = local.tm_year + 1900;
+    day_.month = local.tm_mon + 1;
+    day_.day = local.tm_mday;
+    day_.weekday = local.tm_wday;
+    day_.utcOffset = local.tm_gmtoff;
+    std::strftime(day_.date, sizeof(day_.date), "%b %e", &local);
+
+    int secondOfDay = local.tm_hour * 60 * 60 + local.tm_min * 60 + local.tm_sec;
+    dayStartWall_ = epochSecond + day_.utcOffset - secondOfDay;
+
+    // The window ends at the next midnight, unless the offset changes before then
+    std::time_t nextMidnight = dayStartWall_ + kSecondsPerDay - day_.utcOffset;
+    validFrom_ = epochSecond;
+    validUntil_ = nextMidnight;
+    if (utcOffsetAt(nextMidnight) != day_.utcOffset) {
+        validUntil_ = findTransition(epochSecond, nextMidnight, day_.utcOffset);
+    }
+}
+
+std::time_t TimeService::findTransition(std::time_t from, std::time_t to, long offset) {
+    // Zones change their offset at most once a day, so the offset is `offset` up to the
+    // transition and different from there on
+    while (to - from > 1) {
+        std::time_t middle = from + (to - from) / 2;
+        if (utcOffsetAt(middle) == offset) {
+            from = middle;
+        } else {
+            to = middle;
+        }
+    }
+    return to;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+
+// Local wall-clock time for one instant, broken down the way the clock face needs it
+struct CivilTime {
+    std::time_t epochSecond = 0;
+    int year = 1970;
+    int month = 1;       // 1-12
+    int day = 1;         // 1-31
+    int weekday = 4;     // 0 = Sunday
+    int hour = 0;        // 0-23
+    int minute = 0;
+    int second = 0;
+    // Wall-clock seconds since local midnight: 02:30 is 9000 even on the night the clocks change
+    int secondOfDay = 0;
+    // UTC offset in effect, in seconds east of Greenwich
+    long utcOffset = 0;
+    // "Oct 15", like strftime's "%b %e"
+    char date[16] = "";
+
+    int hour12() const {
+        return (hour % 12 == 0) ? 12 : hour % 12;
+    }
+
+    const char *meridiem() const {
+        return (hour < 12) ? "AM" : "PM";
+    }
+};
+
+// Converts the wall clock to local time without asking libc on every frame. The UTC offset and
+// the date are looked up with localtime_r() once, together with when they next change: the next
+// local midnight or, if one comes first, the next DST transition. Until then a conversion is a
+// clock read plus integer math. A clock that is stepped backwards, or past the end of the
+// window, triggers a fresh lookup.
+//
+// The time zone is read once per window, so a change to TZ or the zone files shows up at the
+// next midnight or transition at the latest.
+class TimeService {
+public:
+    TimeService() = default;
+
+    TimeService(const TimeService &) = delete;
+    TimeService &operator=(const TimeService &) = delete;
+
+    // Read the clock once per frame and pass the result around, so every string drawn in a frame
+    // agrees on the second
+    CivilTime now();
+    CivilTime at(std::time_t epochSecond);
+
+    // Cache refreshes since startup: one a day, plus DST transitions and clock steps
+    unsigned long recomputations() const {
+        return recomputations_;
+    }
+
+private:
+    void recompute(std::time_t epochSecond);
+    // First second in (from, to] whose UTC offset differs from the one at `from`
+    static std::time_t findTransition(std::time_t from, std::time_t to, long offset);
+
+    // [validFrom_, validUntil_) shares one UTC offset and one local date
+    std::time_t validFrom_ = 0;
+    std::time_t validUntil_ = 0;
+    // Local midnight in wall-clock seconds (epoch seconds plus the UTC offset)
+    std::time_t dayStartWall_ = 0;
+    // Date fields and offset for the window
+    CivilTime day_;
+    unsigned long recomputations_ = 0;
+};
@@ -0,0 +1,131 @@
+// Packs the clock's artwork into a C++ header, so the clock reads no files at startup. Run by
+// the build; the output lands in the build directory as asset_bundle_data.h.
+//
+//   led_matrix_pack_assets <output.h> <temperature-scale.png> <icon.png>...
+//
+// The icons, which must all be the same size, are laid side by side in one RGBA8 atlas and named
+// after their file names without the extension. The temperature scale becomes a table of 128
+// colors, one per degree F, sampled from the first column of the image.
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+namespace {
+
+const int kTemperatureColorCount = 128;
+
+std::string iconName(const std::string &path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return (dot == std::string::npos) ? name : name.substr(0, dot);
+}
+
+// Bytes as a comma separated list, a fixed number per line
+void appendBytes(std::string &out, const std::vector<uint8_t> &bytes, int perLine) {
+    for (size_t i = 0; i < bytes.size(); i++) {
+        if (i % perLine == 0) {
+            out += "    ";
+        }
+        out += fmt::format("{},", bytes[i]);
+        out += ((i + 1) % perLine == 0 || i + 1 == bytes.size()) ? "\n" : " ";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cout << "Usage: " << argv[0] << " <output.h> <temperature-scale.png> <icon.png>..." << std::endl;
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+
+    Image scale = LoadImage(argv[2]);
+    if (scale.data == nullptr || scale.height < kTemperatureColorCount) {
+        std::cout << "Temperature scale " << argv[2] << " needs at least " << kTemperatureColorCount << " rows" << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> temperatureColors;
+    for (int i = 0; i < kTemperatureColorCount; i++) {
+        Color color = GetImageColor(scale, 0, i);
+        temperatureColors.insert(temperatureColors.end(), {color.r, color.g, color.b, color.a});
+    }
+    UnloadImage(scale);
+
+    std::vector<std::string> names;
+    std::vector<uint8_t> atlas;
+    int iconWidth = 0;
+    int iconHeight = 0;
+    int iconCount = argc - 3;
+    for (int i = 0; i < iconCount; i++) {
+        const char* path = argv[3 + i];
+        Image icon = LoadImage(path);
+        if (icon.data == nullptr) {
+            std::cout << "Failed to load " << path << std::endl;
+            return 1;
+        }
+        ImageFormat(&icon, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (i == 0) {
+            iconWidth = icon.width;
+            iconHeight = icon.height;
+            atlas.assign(iconWidth * iconCount * iconHeight * 4, 0);
+        } else if (icon.width != iconWidth || icon.height != iconHeight) {
+            std::cout << path << " is " << icon.width << "x" << icon.height << ", expected "
+                      << iconWidth << "x" << iconHeight << std::endl;
+            return 1;
+        }
+        const uint8_t* pixels = (const uint8_t*)icon.data;
+        for (int y = 0; y < iconHeight; y++) {
+            std::copy(pixels + y * iconWidth * 4,
+                      pixels + (y + 1) * iconWidth * 4,
+                      atlas.begin() + (y * iconWidth * iconCount + i * iconWidth) * 4);
+        }
+        UnloadImage(icon);
+        names.push_back(iconName(path));
+    }
+
+    std::string out;
+    out += "// Generated by led_matrix_pack_assets (src/tools/asset_packer.cpp); do not edit\n";
+    out += "#pragma once\n\n";
+    out += "#include <cstdint>\n\n";
+    out += "namespace asset_bundle {\n\n";
+    out += fmt::format("constexpr int kIconCount = {};\n", iconCount);
+    out += fmt::format("constexpr int kIconWidth = {};\n", iconWidth);
+    out += fmt::format("constexpr int kIconHeight = {};\n", iconHeight);
+    out += "constexpr int kIconAtlasWidth = kIconWidth * kIconCount;\n\n";
+    out += "// Icon i covers columns [i * kIconWidth, (i + 1) * kIconWidth) of the atlas\n";
+    out += "constexpr const char* kIconNames[kIconCount] = {\n";
+    for (const std::string &name : names) {
+        out += fmt::format("    \"{}\",\n", name);
+    }
+    out += "};\n\n";
+    out += "// RGBA8, rows top to bottom\n";
+    out += "constexpr uint8_t kIconAtlas[kIconAtlasWidth * kIconHeight * 4] = {\n";
+    appendBytes(out, atlas, 16);
+    out += "};\n\n";
+    out += fmt::format("constexpr int kTemperatureColorCount = {};\n\n", kTemperatureColorCount);
+    out += "// RGBA8 per whole degree F, from 0\n";
+    out += "constexpr uint8_t kTemperatureColors[kTemperatureColorCount][4] = {\n";
+    for (int i = 0; i < kTemperatureColorCount; i++) {
+        const uint8_t* color = temperatureColors.data() + i * 4;
+        out += fmt::format("    {{{}, {}, {}, {}}},\n", color[0], color[1], color[2], color[3]);
+    }
+    out += "};\n\n";
+    out += "}  // namespace asset_bundle\n";
+
+    std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+    file << out;
+    if (!file) {
+        std::cout << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
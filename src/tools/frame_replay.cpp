@@ -0,0 +1,103 @@
+// Plays back a frame recording made by the shim driver (--record=<file>).
+//
+//   led_matrix_replay <recording> [--png=<dir>] [--fast] [--loop] [--led-... flags]
+//
+// By default frames go through MatrixDriver with their original timing, so on a Pi the
+// recording shows up on the panel exactly as the clock drew it. --png=<dir> writes every frame
+// to <dir>/frame_NNNNNN.png instead. --fast ignores the timestamps and pushes frames as quickly
+// as the driver accepts them, which makes a fixed workload for measuring the output path.
+#include "matrix_driver.h"
+#include "output/frame_recording.h"
+#include "raylib.h"
+
+#include <chrono>
+#include <cstring>
+#include <fmt/core.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::string recordingPath;
+    std::string pngDir;
+    bool fast = false;
+    bool loop = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--png=", 6) == 0) {
+            pngDir = argv[i] + 6;
+        } else if (std::strcmp(argv[i], "--fast") == 0) {
+            fast = true;
+        } else if (std::strcmp(argv[i], "--loop") == 0) {
+            loop = true;
+        } else if (argv[i][0] != '-' && recordingPath.empty()) {
+            recordingPath = argv[i];
+        }
+    }
+    if (recordingPath.empty()) {
+        std::cout << "Usage: " << argv[0] << " <recording> [--png=<dir>] [--fast] [--loop]" << std::endl;
+        return 1;
+    }
+
+    FrameRecordingReader reader(recordingPath);
+    if (!reader.isOpen()) {
+        std::cout << "Not a frame recording: " << recordingPath << std::endl;
+        return 1;
+    }
+    const int width = reader.width();
+    const int height = reader.height();
+
+    if (!pngDir.empty()) {
+        uint64_t timestamp = 0;
+        int index = 0;
+        while (reader.readFrame(timestamp)) {
+            Image image = {(void*)reader.frame(), width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8};
+            std::string path = pngDir + "/" + fmt::format("frame_{:06}.png", index++);
+            if (!ExportImage(image, path.c_str())) {
+                std::cout << "Failed to write " << path << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "Wrote " << index << " frames to " << pngDir << std::endl;
+        return 0;
+    }
+
+    MatrixDriver matrixDriver(&argc, &argv, width, height);
+    std::vector<uint8_t> rgba(width * height * 4, 255);
+    // Recordings already have brightness and calibration applied
+    ColorLut identity;
+
+    uint64_t framesShown = 0;
+    auto replayStart = std::chrono::steady_clock::now();
+    do {
+        FrameRecordingReader pass(recordingPath);
+        auto passStart = std::chrono::steady_clock::now();
+        uint64_t timestamp = 0;
+        uint64_t passFrames = 0;
+        while (pass.readFrame(timestamp)) {
+            const uint8_t* rgb = pass.frame();
+            for (int i = 0; i < width * height; i++) {
+                rgba[i * 4 + 0] = rgb[i * 3 + 0];
+                rgba[i * 4 + 1] = rgb[i * 3 + 1];
+                rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            }
+            if (!fast) {
+                std::this_thread::sleep_until(passStart + std::chrono::microseconds(timestamp));
+            }
+            matrixDriver.writeFrame(rgba.data(), width * 4, false, identity);
+            matrixDriver.flipBuffer();
+            framesShown++;
+            passFrames++;
+        }
+        if (passFrames == 0) {
+            // Nothing to show (or to wait on), so --loop would reopen the file as fast as it can
+            std::cout << "No frames in " << recordingPath << std::endl;
+            return 1;
+        }
+    } while (loop);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+    std::cout << "Replayed " << framesShown << " frames in " << seconds << " s ("
+              << (seconds > 0 ? framesShown / seconds : 0.0) << " frames/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Weather codes at bottom of https://open-meteo.com/en/docs map onto these icons
+typedef enum WeatherType
+{
+    full_sun = 1,
+    full_moon = 8,
+    partial_sun = 2,
+    partial_moon = 7,
+    cloudy = 3,
+    cloudy_rain = 4,
+    cloudy_snow = 5,
+    cloudy_thunder = 6
+} WeatherType;
+
+// One decoded forecast. WeatherService publishes these as immutable snapshots; the render loop
+// only ever reads them.
+struct Forecast {
+    static const int kHours = 24;
+
+    // Whole degrees F for the next 24 hours; [0] is the current temperature
+    std::array<int, kHours> temperatures;
+    int weatherCode = -1;
+    WeatherType type = WeatherType::full_sun;
+    bool isDaytime = true;
+    uint64_t sunriseMillis = 0;
+    uint64_t sunsetMillis = 0;
+    // When the data was fetched (ms since the epoch); 0 for the placeholder shown before that
+    uint64_t fetchedMillis = 0;
+
+    Forecast() {
+        temperatures.fill(60);
+    }
+};
@@ -0,0 +1,146 @@
+#include "weather/forecast_cache.h"
+#include "weather/open_meteo.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const uint64_t kHourMillis = 60 * 60 * 1000;
+const uint64_t kDayMillis = 24 * kHourMillis;
+
+void putLE(std::vector<uint8_t> &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back((value >> (i * 8)) & 0xff);
+    }
+}
+
+uint64_t getLE(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (i * 8);
+    }
+    return value;
+}
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool writeAll(int fd, const std::vector<uint8_t> &bytes) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t n = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+std::string directoryOf(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+}  // namespace
+
+bool saveForecastCache(const std::string &path, const Forecast &forecast) {
+    std::vector<uint8_t> bytes(forecast_cache::kMagic, forecast_cache::kMagic + sizeof(forecast_cache::kMagic));
+    putLE(bytes, forecast_cache::kVersion, 2);
+    putLE(bytes, forecast.fetchedMillis, 8);
+    putLE(bytes, forecast.sunriseMillis, 8);
+    putLE(bytes, forecast.sunsetMillis, 8);
+    putLE(bytes, (uint16_t)(int16_t)forecast.weatherCode, 2);
+    putLE(bytes, Forecast::kHours, 1);
+    for (int temperature : forecast.temperatures) {
+        putLE(bytes, (uint16_t)(int16_t)temperature, 2);
+    }
+    putLE(bytes, fnv1a(bytes.data(), bytes.size()), 4);
+
+    std::string tempPath = path + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cout << "Failed to write weather cache " << tempPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bool ok = writeAll(fd, bytes) && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cout << "Failed to write weather cache " << path << ": " << std::strerror(errno) << std::endl;
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+    // Make the rename itself durable
+    int dirFd = ::open(directoryOf(path).c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+bool loadForecastCache(const std::string &path, uint64_t nowMillis, Forecast &forecast) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const size_t headerSize = 4 + 2 + 8 + 8 + 8 + 2 + 1;
+    const size_t expectedSize = headerSize + Forecast::kHours * 2 + 4;
+    if (bytes.size() != expectedSize
+        || std::memcmp(bytes.data(), forecast_cache::kMagic, sizeof(forecast_cache::kMagic)) != 0
+        || getLE(bytes.data() + 4, 2) != forecast_cache::kVersion
+        || bytes[headerSize - 1] != Forecast::kHours
+        || getLE(bytes.data() + expectedSize - 4, 4) != fnv1a(bytes.data(), expectedSize - 4)) {
+        std::cout << "Ignoring unreadable weather cache " << path << std::endl;
+        return false;
+    }
+
+    Forecast cached;
+    cached.fetchedMillis = getLE(bytes.data() + 6, 8);
+    cached.sunriseMillis = getLE(bytes.data() + 14, 8);
+    cached.sunsetMillis = getLE(bytes.data() + 22, 8);
+    cached.weatherCode = (int16_t)getLE(bytes.data() + 30, 2);
+    if (cached.fetchedMillis == 0 || cached.fetchedMillis > nowMillis || nowMillis - cached.fetchedMillis >= kDayMillis) {
+        return false;
+    }
+
+    // Hour 0 is now, so drop the hours that have passed and repeat the last known one at the end
+    int elapsedHours = (int)((nowMillis - cached.fetchedMillis) / kHourMillis);
+    for (int i = 0; i < Forecast::kHours; i++) {
+        int source = std::min(i + elapsedHours, Forecast::kHours - 1);
+        cached.temperatures[i] = (int16_t)getLE(bytes.data() + headerSize + source * 2, 2);
+    }
+
+    // Sunrise and sunset were for the day of the fetch; a day later they are close enough
+    if (nowMillis >= cached.sunriseMillis + kDayMillis) {
+        cached.sunriseMillis += kDayMillis;
+        cached.sunsetMillis += kDayMillis;
+    }
+    cached.isDaytime = nowMillis > cached.sunriseMillis && nowMillis <= cached.sunsetMillis;
+    cached.type = weatherTypeForCode(cached.weatherCode, cached.isDaytime);
+
+    forecast = cached;
+    return true;
+}
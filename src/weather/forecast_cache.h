@@ -0,0 +1,28 @@
+#pragma once
+
+#include "weather/forecast.h"
+
+#include <cstdint>
+#include <string>
+
+// The last decoded forecast, kept on disk so a restarted clock shows real data on its first
+// frame instead of placeholders. Layout (all integers little-endian):
+//
+//   "LMWC", u16 version, u64 fetched ms, u64 sunrise ms, u64 sunset ms, i16 weather code,
+//   u8 hour count, i16 temperature per hour, u32 FNV-1a checksum of everything before it
+//
+// The file is replaced atomically (written to a temporary file, synced, then renamed), so a
+// power cut leaves either the old forecast or the new one, never a torn file.
+namespace forecast_cache {
+
+const char kMagic[4] = {'L', 'M', 'W', 'C'};
+const uint16_t kVersion = 1;
+
+}  // namespace forecast_cache
+
+bool saveForecastCache(const std::string &path, const Forecast &forecast);
+
+// Loads the cached forecast and moves it forward to `nowMillis`: the hourly temperatures shift
+// by the hours that passed since the fetch and day/night is worked out again. Returns false if
+// there is no usable cache, including one more than a day old.
+bool loadForecastCache(const std::string &path, uint64_t nowMillis, Forecast &forecast);
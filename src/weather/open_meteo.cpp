@@ -0,0 +1,294 @@
+#include "weather/open_meteo.h"
+
+#include <array>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Longest hourly series open-meteo serves (16 forecast days)
+const int kMaxHourly = 16 * 24;
+
+// Streams the response and keeps only what the clock shows: the current temperature and weather
+// code, the hourly entries from now on (the first 24 of them), and today's sunrise and sunset.
+// Everything lands in fixed-size arrays; no DOM, vectors or string copies are built.
+class OpenMeteoDecoder : public nlohmann::json_sax<json> {
+public:
+    explicit OpenMeteoDecoder(uint64_t nowSeconds) : nowSeconds_(nowSeconds) {}
+
+    bool null() override {
+        return scalar(0.0, false);
+    }
+
+    bool boolean(bool) override {
+        return scalar(0.0, false);
+    }
+
+    bool number_integer(number_integer_t val) override {
+        return scalar((double)val, true);
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        return scalar((double)val, true);
+    }
+
+    bool number_float(number_float_t val, const string_t &) override {
+        return scalar(val, true);
+    }
+
+    bool string(string_t &) override {
+        return scalar(0.0, false);
+    }
+
+    bool binary(binary_t &) override {
+        return scalar(0.0, false);
+    }
+
+    bool start_object(std::size_t) override {
+        depth_++;
+        if (depth_ == 2) {
+            section_ = pendingSection_;
+        }
+        return true;
+    }
+
+    bool key(string_t &val) override {
+        if (depth_ == 1) {
+            pendingSection_ = val == "current_weather" ? Section::Current
+                            : val == "hourly" ? Section::Hourly
+                            : val == "daily" ? Section::Daily
+                            : Section::None;
+        } else if (depth_ == 2) {
+            field_ = Field::None;
+            if (section_ == Section::Current) {
+                field_ = val == "temperature" ? Field::Temperature
+                       : val == "weathercode" ? Field::WeatherCode
+                       : Field::None;
+            } else if (section_ == Section::Hourly) {
+                field_ = val == "time" ? Field::Time
+                       : val == "temperature_2m" ? Field::HourlyTemperature
+                       : Field::None;
+            } else if (section_ == Section::Daily) {
+                field_ = val == "sunrise" ? Field::Sunrise
+                       : val == "sunset" ? Field::Sunset
+                       : Field::None;
+            }
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth_ == 2) {
+            section_ = Section::None;
+            field_ = Field::None;
+        }
+        depth_--;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        depth_++;
+        if (depth_ == 3) {
+            arrayIndex_ = 0;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (depth_ == 3 && field_ == Field::Time) {
+            timesSeen_ = true;
+        } else if (depth_ == 3 && field_ == Field::HourlyTemperature) {
+            temperaturesSeen_ = true;
+        }
+        depth_--;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &ex) override {
+        std::cout << "Failed to parse weather API!" << ex.what() << std::endl;
+        return false;
+    }
+
+    // Moves the decoded values into `forecast`, or returns false if a field the clock needs
+    // was missing
+    bool finish(Forecast &forecast) const {
+        if (!hasCurrentTemperature_ || !hasWeatherCode_ || !hasSunrise_ || !hasSunset_
+            || !timesSeen_ || !temperaturesSeen_) {
+            std::cout << "Failed to parse weather API! Missing fields in the forecast" << std::endl;
+            return false;
+        }
+        for (int k = 0; k < windowCount_; k++) {
+            double temperature = 0.0;
+            if (temperatureBeforeTimes_) {
+                if (firstHour_ + k >= temperatureCount_) {
+                    continue;
+                }
+                temperature = pending_[firstHour_ + k];
+            } else {
+                if (k >= windowTemperatureCount_) {
+                    continue;
+                }
+                temperature = window_[k];
+            }
+            int hourRelative = (int)((windowTimes_[k] - nowSeconds_) / 3600.0);
+            if (hourRelative < Forecast::kHours) {
+                forecast.temperatures[hourRelative] = (int)temperature;
+            }
+        }
+        forecast.temperatures[0] = (int)currentTemperature_;
+        forecast.weatherCode = weatherCode_;
+        forecast.sunriseMillis = sunrise_ * 1000;
+        forecast.sunsetMillis = sunset_ * 1000;
+        return true;
+    }
+
+private:
+    enum class Section { None, Current, Hourly, Daily };
+    enum class Field { None, Temperature, WeatherCode, Time, HourlyTemperature, Sunrise, Sunset };
+
+    // Entries kept from the hourly series; one more than the display needs in case the first
+    // one lands a fraction of an hour ahead
+    static const int kWindow = Forecast::kHours + 1;
+
+    bool scalar(double value, bool isNumber) {
+        if (depth_ == 2 && isNumber) {
+            if (field_ == Field::Temperature) {
+                currentTemperature_ = value;
+                hasCurrentTemperature_ = true;
+            } else if (field_ == Field::WeatherCode) {
+                weatherCode_ = (int)value;
+                hasWeatherCode_ = true;
+            }
+        } else if (depth_ == 3) {
+            int index = arrayIndex_++;
+            if (!isNumber) {
+                return true;
+            }
+            if (field_ == Field::Time) {
+                hourlyTime(index, (uint64_t)value);
+            } else if (field_ == Field::HourlyTemperature) {
+                hourlyTemperature(index, value);
+            } else if (field_ == Field::Sunrise && index == 0) {
+                sunrise_ = (uint64_t)value;
+                hasSunrise_ = true;
+            } else if (field_ == Field::Sunset && index == 0) {
+                sunset_ = (uint64_t)value;
+                hasSunset_ = true;
+            }
+        }
+        return true;
+    }
+
+    void hourlyTime(int index, uint64_t timestamp) {
+        if (firstHour_ < 0 && timestamp >= nowSeconds_) {
+            firstHour_ = index;
+        }
+        if (firstHour_ >= 0 && index - firstHour_ < kWindow) {
+            windowTimes_[index - firstHour_] = timestamp;
+            windowCount_ = index - firstHour_ + 1;
+        }
+    }
+
+    void hourlyTemperature(int index, double temperature) {
+        if (timesSeen_) {
+            // The usual order: the window is known, keep just that part
+            int k = index - firstHour_;
+            if (firstHour_ >= 0 && k >= 0 && k < kWindow) {
+                window_[k] = temperature;
+                windowTemperatureCount_ = k + 1;
+            }
+        } else {
+            // Temperatures before times; hold on to them until the window is known
+            temperatureBeforeTimes_ = true;
+            if (index < kMaxHourly) {
+                pending_[index] = temperature;
+                temperatureCount_ = index + 1;
+            }
+        }
+    }
+
+    uint64_t nowSeconds_;
+    int depth_ = 0;
+    Section pendingSection_ = Section::None;
+    Section section_ = Section::None;
+    Field field_ = Field::None;
+    int arrayIndex_ = 0;
+
+    double currentTemperature_ = 0.0;
+    bool hasCurrentTemperature_ = false;
+    int weatherCode_ = 0;
+    bool hasWeatherCode_ = false;
+    uint64_t sunrise_ = 0;
+    bool hasSunrise_ = false;
+    uint64_t sunset_ = 0;
+    bool hasSunset_ = false;
+
+    bool timesSeen_ = false;
+    bool temperaturesSeen_ = false;
+    int firstHour_ = -1;
+    std::array<uint64_t, kWindow> windowTimes_{};
+    int windowCount_ = 0;
+    std::array<double, kWindow> window_{};
+    int windowTemperatureCount_ = 0;
+    bool temperatureBeforeTimes_ = false;
+    std::array<double, kMaxHourly> pending_{};
+    int temperatureCount_ = 0;
+};
+
+}  // namespace
+
+bool parseOpenMeteoForecast(const std::string &body, uint64_t nowMillis, Forecast &forecast) {
+    Forecast decoded = forecast;
+    OpenMeteoDecoder decoder(nowMillis / 1000);
+    if (!json::sax_parse(body, &decoder) || !decoder.finish(decoded)) {
+        return false;
+    }
+
+    // After sunrise and before sunset
+    decoded.isDaytime = nowMillis > decoded.sunriseMillis && nowMillis <= decoded.sunsetMillis;
+    decoded.type = weatherTypeForCode(decoded.weatherCode, decoded.isDaytime);
+    decoded.fetchedMillis = nowMillis;
+
+    std::cout << "Sunrise today: " << decoded.sunriseMillis << std::endl;
+    std::cout << "Sunset today: " << decoded.sunsetMillis << std::endl;
+    std::cout << "Is daytime: " << decoded.isDaytime << std::endl;
+    std::cout << "Current weather code: " << decoded.weatherCode << std::endl;
+    std::cout << "Current temperature: " << decoded.temperatures[0] << std::endl;
+
+    forecast = decoded;
+    return true;
+}
+
+WeatherType weatherTypeForCode(int weatherCode, bool isDaytime) {
+    switch (weatherCode) {
+        case 0:
+        case 1:
+            // Clear sky, mainly clear
+            return isDaytime ? WeatherType::full_sun : WeatherType::full_moon;
+        case 2:
+            // Partly cloudy
+            return isDaytime ? WeatherType::partial_sun : WeatherType::partial_moon;
+        case 3:
+        case 45:
+        case 48:
+            // Overcast, fog
+            return WeatherType::cloudy;
+        case 51: case 53: case 55: case 56: case 57:
+        case 61: case 63: case 65: case 66: case 67:
+        case 80: case 81: case 82:
+            // Drizzle, rain, showers
+            return WeatherType::cloudy_rain;
+        case 71: case 73: case 75: case 77:
+        case 85: case 86:
+            // Snow
+            return WeatherType::cloudy_snow;
+        case 95: case 96: case 99:
+            // Thunderstorm
+            return WeatherType::cloudy_thunder;
+        default:
+            return isDaytime ? WeatherType::partial_sun : WeatherType::partial_moon;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "weather/forecast.h"
+
+#include <cstdint>
+#include <string>
+
+// Decodes an open-meteo /v1/forecast response (unixtime, hourly temperature_2m, daily
+// sunrise/sunset, current_weather) into `forecast`. Hours missing from the response keep
+// whatever `forecast` held before. Returns false, leaving `forecast` untouched, if the body
+// does not parse.
+bool parseOpenMeteoForecast(const std::string &body, uint64_t nowMillis, Forecast &forecast);
+
+// Picks the icon for an open-meteo weather code
+WeatherType weatherTypeForCode(int weatherCode, bool isDaytime);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+// When to poll the weather API next. Successful polls are spaced by the refresh interval with
+// +/-10% jitter, so clocks that booted together drift apart instead of polling in lockstep.
+// Failures back off exponentially from `minBackoff` up to `maxBackoff`, each delay drawn from
+// the upper half of its window so retries during an outage are spread out too.
+class PollSchedule {
+public:
+    PollSchedule(std::chrono::seconds refreshInterval,
+                 std::chrono::seconds minBackoff = std::chrono::seconds(10),
+                 std::chrono::seconds maxBackoff = std::chrono::minutes(15))
+        : refreshInterval_(refreshInterval)
+        , minBackoff_(minBackoff)
+        , maxBackoff_(std::max(maxBackoff, minBackoff))
+        , rng_(std::random_device{}()) {}
+
+    // Delay before the very first poll: a few seconds, so a fleet restarting after a power cut
+    // does not arrive at the same instant
+    std::chrono::milliseconds initialDelay() {
+        return std::chrono::milliseconds(uniform(0, 3000));
+    }
+
+    // Delay after a poll with the given outcome
+    std::chrono::milliseconds next(bool succeeded) {
+        using std::chrono::milliseconds;
+        if (succeeded) {
+            failures_ = 0;
+            auto base = std::chrono::duration_cast<milliseconds>(refreshInterval_).count();
+            return milliseconds(base + uniform(-base / 10, base / 10));
+        }
+        failures_++;
+        // Doubling stops well before it could overflow; maxBackoff caps it long before that
+        int doublings = std::min(failures_ - 1, 20);
+        auto window = std::min(std::chrono::duration_cast<milliseconds>(minBackoff_).count() << doublings,
+                               std::chrono::duration_cast<milliseconds>(maxBackoff_).count());
+        return milliseconds(window / 2 + uniform(0, window / 2));
+    }
+
+    int consecutiveFailures() const {
+        return failures_;
+    }
+
+private:
+    long long uniform(long long low, long long high) {
+        return std::uniform_int_distribution<long long>(low, high)(rng_);
+    }
+
+    std::chrono::seconds refreshInterval_;
+    std::chrono::seconds minBackoff_;
+    std::chrono::seconds maxBackoff_;
+    std::mt19937 rng_;
+    int failures_ = 0;
+};
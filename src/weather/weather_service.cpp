@@ -0,0 +1,187 @@
+#include "weather/weather_service.h"
+#include "weather/forecast_cache.h"
+#include "weather/open_meteo.h"
+#include "weather/poll_schedule.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <cpr/cpr.h>
+
+namespace {
+
+// Anything shorter would just be hammering the API
+const std::chrono::seconds kMinRefreshInterval(10);
+// Part of the request timeout; an unreachable host should fail well before a slow response would
+const std::chrono::milliseconds kConnectTimeout(5000);
+
+uint64_t nowMillis() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+bool parseSeconds(const char* text, const char* flag, std::chrono::seconds &out) {
+    char* end = nullptr;
+    long value = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value <= 0) {
+        std::cout << "Ignoring " << flag << "='" << text << "', expected a positive number of seconds" << std::endl;
+        return false;
+    }
+    out = std::chrono::seconds(value);
+    return true;
+}
+
+}  // namespace
+
+WeatherOptions WeatherOptions::FromArgs(int argc, char **argv) {
+    WeatherOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--weather-url=", 14) == 0) {
+            options.url = argv[i] + 14;
+        } else if (std::strncmp(argv[i], "--weather-interval=", 19) == 0) {
+            parseSeconds(argv[i] + 19, "--weather-interval", options.refreshInterval);
+        } else if (std::strncmp(argv[i], "--weather-max-age=", 18) == 0) {
+            parseSeconds(argv[i] + 18, "--weather-max-age", options.maxAge);
+        } else if (std::strncmp(argv[i], "--weather-timeout=", 18) == 0) {
+            parseSeconds(argv[i] + 18, "--weather-timeout", options.requestTimeout);
+        } else if (std::strncmp(argv[i], "--weather-cache=", 16) == 0) {
+            options.cachePath = argv[i] + 16;
+        }
+    }
+    options.refreshInterval = std::max(options.refreshInterval, kMinRefreshInterval);
+    return options;
+}
+
+WeatherService::WeatherService(const WeatherOptions &options, ClockMetrics* metrics)
+    : options_(options)
+    , metrics_(metrics)
+    , latest_(std::make_shared<const Forecast>()) {
+    Forecast cached;
+    if (!options_.cachePath.empty() && loadForecastCache(options_.cachePath, nowMillis(), cached)) {
+        std::cout << "Loaded cached forecast from " << (nowMillis() - cached.fetchedMillis) / 1000 << " s ago" << std::endl;
+        latest_ = std::make_shared<const Forecast>(cached);
+    }
+}
+
+WeatherService::~WeatherService() {
+    stop();
+}
+
+void WeatherService::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    worker_ = std::thread([this]() {
+        run();
+    });
+}
+
+void WeatherService::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        // Orders the flag before a worker that is about to wait, so the wakeup cannot be missed
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::shared_ptr<const Forecast> WeatherService::latest() const {
+    return std::atomic_load(&latest_);
+}
+
+void WeatherService::run() {
+    // One session for the life of the worker, so curl can reuse the connection between polls
+    cpr::Session session;
+    session.SetUrl(cpr::Url{options_.url});
+    auto requestTimeout = std::chrono::duration_cast<std::chrono::milliseconds>(options_.requestTimeout);
+    session.SetConnectTimeout(cpr::ConnectTimeout{std::min(kConnectTimeout, requestTimeout)});
+    session.SetTimeout(cpr::Timeout{requestTimeout});
+
+    PollSchedule schedule(options_.refreshInterval);
+    std::chrono::milliseconds delay = schedule.initialDelay();
+    // A cached forecast is good for the rest of its refresh interval
+    uint64_t cachedAt = latest()->fetchedMillis;
+    if (cachedAt != 0) {
+        auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(options_.refreshInterval).count();
+        uint64_t dueAt = cachedAt + interval;
+        uint64_t now = nowMillis();
+        if (dueAt > now) {
+            delay = std::max(delay, std::chrono::milliseconds(dueAt - now));
+        }
+    }
+
+    // Validators from the last response, for conditional requests; a 304 re-decodes `lastBody`
+    // so the hourly values still line up with the current hour
+    std::string etag;
+    std::string lastModified;
+    std::string lastBody;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            if (wake_.wait_for(lock, delay, [this]() { return !running_; })) {
+                break;
+            }
+        }
+
+        cpr::Header headers;
+        if (!etag.empty()) {
+            headers["If-None-Match"] = etag;
+        }
+        if (!lastModified.empty()) {
+            headers["If-Modified-Since"] = lastModified;
+        }
+        session.SetHeader(headers);
+
+        std::cout << "Querying weather API..." << std::endl;
+        auto fetchStart = std::chrono::steady_clock::now();
+        uint64_t queryTime = nowMillis();
+        cpr::Response r = session.Get();
+
+        bool updated = false;
+        if (r.status_code == 200 || (r.status_code == 304 && !lastBody.empty())) {
+            if (r.status_code == 200) {
+                lastBody = std::move(r.text);
+                auto header = r.header.find("ETag");
+                etag = header != r.header.end() ? header->second : "";
+                header = r.header.find("Last-Modified");
+                lastModified = header != r.header.end() ? header->second : "";
+            } else {
+                std::cout << "Weather API reports the forecast unchanged" << std::endl;
+            }
+            Forecast forecast = *latest();
+            if (parseOpenMeteoForecast(lastBody, queryTime, forecast)) {
+                std::atomic_store(&latest_, std::shared_ptr<const Forecast>(std::make_shared<Forecast>(forecast)));
+                updated = true;
+                if (!options_.cachePath.empty()) {
+                    saveForecastCache(options_.cachePath, forecast);
+                }
+            } else {
+                lastBody.clear();
+                etag.clear();
+                lastModified.clear();
+            }
+        } else if (r.error) {
+            std::cout << "Failed to query weather API! " << r.error.message << std::endl;
+        } else {
+            std::cout << "Failed to query weather API! Status code: " << r.status_code << "msg: " << r.text << std::endl;
+        }
+        if (metrics_ != nullptr) {
+            metrics_->weatherFetched(std::chrono::steady_clock::now() - fetchStart, updated);
+        }
+
+        delay = schedule.next(updated);
+        if (!updated) {
+            std::cout << "Retrying weather API in " << delay.count() / 1000 << " s (failure "
+                      << schedule.consecutiveFailures() << " in a row)" << std::endl;
+        }
+    }
+}
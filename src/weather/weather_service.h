@@ -0,0 +1,69 @@
+#pragma once
+
+#include "metrics/clock_metrics.h"
+#include "weather/forecast.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct WeatherOptions {
+    std::string url = "https://api.open-meteo.com/v1/forecast?latitude=42.39&longitude=-71.10&hourly=temperature_2m,weathercode&timezone=America/New_York&current_weather=true&temperature_unit=fahrenheit&timeformat=unixtime&daily=sunrise,sunset";
+    // Time between successful polls (jittered by PollSchedule)
+    std::chrono::seconds refreshInterval{60};
+    // A forecast older than this is shown dimmed
+    std::chrono::seconds maxAge{2 * 60 * 60};
+    // Longest a single poll may take, connecting included. Generous for a Pi on Wi-Fi, but
+    // bounded so a dead link cannot hold the worker (or stop()) forever
+    std::chrono::seconds requestTimeout{15};
+    // Where the last forecast is kept between runs; empty to disable
+    std::string cachePath = "weather-cache.bin";
+
+    // Accepts `--weather-url=`, `--weather-interval=<seconds>`, `--weather-max-age=<seconds>`,
+    // `--weather-timeout=<seconds>` and `--weather-cache=<path>`
+    static WeatherOptions FromArgs(int argc, char **argv);
+
+    bool isStale(const Forecast &forecast, uint64_t nowMillis) const {
+        return forecast.fetchedMillis == 0 ||
+               nowMillis - forecast.fetchedMillis > (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(maxAge).count();
+    }
+};
+
+// Fetches and decodes the forecast on its own thread, so a slow DNS lookup or TLS handshake
+// never stalls the clock. Each successful fetch publishes a new immutable Forecast with an
+// atomic pointer swap; the render loop calls latest() once per frame and never waits. Failed
+// polls back off (see PollSchedule) and the last good forecast stays published meanwhile.
+// The forecast is also cached on disk and loaded by the constructor, so the first frame after a
+// restart already has real data and a recent enough cache delays the first poll.
+class WeatherService {
+public:
+    // `metrics` (optional) receives the latency and outcome of every fetch
+    WeatherService(const WeatherOptions &options, ClockMetrics* metrics = nullptr);
+    ~WeatherService();
+
+    WeatherService(const WeatherService &) = delete;
+    WeatherService &operator=(const WeatherService &) = delete;
+
+    void start();
+    void stop();
+
+    // Never null; a placeholder forecast until the first fetch succeeds
+    std::shared_ptr<const Forecast> latest() const;
+
+private:
+    void run();
+
+    WeatherOptions options_;
+    ClockMetrics* metrics_;
+    // Only accessed through std::atomic_load / std::atomic_store
+    std::shared_ptr<const Forecast> latest_;
+
+    std::thread worker_;
+    std::atomic<bool> running_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+};
@@ -0,0 +1,313 @@
+// BoundedMpscQueue and the request handling in AnimationManager: concurrent producers, the
+// queue-full rejection, priority interrupts and resumption, playlists and the status snapshot.
+// The manager runs with clips disabled and is driven the way the render loop drives it, with
+// Update() calls a few milliseconds apart; durations are real time, so the timing checks leave
+// generous margins.
+
+#include "check.h"
+
+#include "animations/animation_manager.h"
+#include "animations/request_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// What each producer pushes: its own id and a counter of its own
+struct Item {
+    uint32_t producer = 0;
+    uint32_t sequence = 0;
+};
+
+void testQueueCapacity() {
+    BoundedMpscQueue<int, 8> queue;
+    for (int i = 0; i < 8; i++) {
+        CHECK(queue.TryPush(i));
+    }
+    CHECK(!queue.TryPush(8));
+
+    // Freeing a cell makes room for exactly one more, and order holds across the wrap
+    int value = -1;
+    CHECK(queue.TryPop(value));
+    CHECK_EQ(value, 0);
+    CHECK(queue.TryPush(8));
+    CHECK(!queue.TryPush(9));
+    for (int expected = 1; expected <= 8; expected++) {
+        CHECK(queue.TryPop(value));
+        CHECK_EQ(value, expected);
+    }
+    CHECK(!queue.TryPop(value));
+}
+
+void testConcurrentProducers() {
+    const uint32_t kProducers = 4;
+    const uint32_t kItemsEach = 50000;
+    // Much smaller than the total, so producers keep finding the queue full and retrying
+    BoundedMpscQueue<Item, 64> queue;
+    std::atomic<uint64_t> refusals{0};
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < kProducers; producer++) {
+        producers.emplace_back([&, producer]() {
+            for (uint32_t sequence = 0; sequence < kItemsEach; sequence++) {
+                while (!queue.TryPush(Item{producer, sequence})) {
+                    refusals.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Each producer's items must arrive exactly once and in the order it pushed them
+    std::vector<uint32_t> next(kProducers, 0);
+    uint64_t received = 0;
+    uint64_t outOfOrder = 0;
+    Item item;
+    while (received < (uint64_t)kProducers * kItemsEach) {
+        if (!queue.TryPop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item.producer >= kProducers || item.sequence != next[item.producer]) {
+            outOfOrder++;
+        } else {
+            next[item.producer]++;
+        }
+        received++;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    CHECK_EQ(outOfOrder, 0u);
+    for (uint32_t producer = 0; producer < kProducers; producer++) {
+        CHECK_EQ(next[producer], kItemsEach);
+    }
+    // Nothing left over, so nothing was pushed twice
+    CHECK(!queue.TryPop(item));
+    std::cout << kProducers << " producers, " << received << " items, " << refusals.load()
+              << " pushes refused while full" << std::endl;
+}
+
+AnimationRequest requestFor(const AnimationManager &manager,
+                            const std::vector<std::string> &names,
+                            milliseconds duration,
+                            int priority = 0) {
+    AnimationRequest request;
+    for (const std::string &name : names) {
+        request.playlist[request.playlistLength++] = (uint8_t)manager.FindAnimation(name).value();
+    }
+    request.duration = duration;
+    request.priority = priority;
+    return request;
+}
+
+std::string activeName(const AnimationManager &manager) {
+    const char* name = manager.ActiveAnimationName();
+    return name ? name : "";
+}
+
+// Calls Update() every few milliseconds until `done` or the timeout; true if `done` happened
+template <typename Done>
+bool updateUntil(AnimationManager &manager, Done done, milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        manager.Update(0.005f);
+        if (done()) {
+            return true;
+        }
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    return false;
+}
+
+void testSubmitRejectsWhenFull() {
+    AnimationManager manager(64, 32, 0);
+
+    AnimationRequest invalid;
+    CHECK(manager.Submit(invalid) == AnimationManager::SubmitResult::Invalid);
+    invalid.playlistLength = 1;
+    invalid.playlist[0] = 200;
+    CHECK(manager.Submit(invalid) == AnimationManager::SubmitResult::Invalid);
+    AnimationRequest noTime = requestFor(manager, {"fire"}, milliseconds(0));
+    CHECK(manager.Submit(noTime) == AnimationManager::SubmitResult::Invalid);
+
+    // Nothing is taken off the queue until Update(), so a burst fills it
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < AnimationManager::kQueueCapacity; i++) {
+        AnimationRequest request = requestFor(manager, {"sparkle"}, milliseconds(60000));
+        CHECK(manager.Submit(request) == AnimationManager::SubmitResult::Accepted);
+        ids.push_back(request.id);
+    }
+    AnimationRequest refused = requestFor(manager, {"fire"}, milliseconds(60000));
+    CHECK(manager.Submit(refused) == AnimationManager::SubmitResult::QueueFull);
+    CHECK_EQ(manager.CurrentStatus().rejected, 1u);
+    for (size_t i = 1; i < ids.size(); i++) {
+        CHECK(ids[i] > ids[i - 1]);
+    }
+
+    // One Update() moves the burst into the pending list and starts the first request
+    manager.Update(0.0f);
+    AnimationManager::Status status = manager.CurrentStatus();
+    CHECK_EQ(status.activeRequest, ids.front());
+    CHECK_EQ(status.queued, (uint32_t)(AnimationManager::kQueueCapacity - 1));
+    CHECK(manager.Submit(refused) == AnimationManager::SubmitResult::Accepted);
+    CHECK_EQ(manager.CurrentStatus().rejected, 1u);
+    CHECK_EQ(manager.CurrentStatus().dropped, 0u);
+}
+
+void testPriorityInterruptResumes() {
+    AnimationManager manager(64, 32, 0);
+
+    AnimationRequest background = requestFor(manager, {"fire"}, milliseconds(800));
+    CHECK(manager.Submit(background) == AnimationManager::SubmitResult::Accepted);
+    manager.Update(0.0f);
+    CHECK_EQ(activeName(manager), std::string("fire"));
+    auto backgroundStart = std::chrono::steady_clock::now();
+
+    // An equal priority waits its turn
+    AnimationRequest sameRank = requestFor(manager, {"starfield"}, milliseconds(100));
+    CHECK(manager.Submit(sameRank) == AnimationManager::SubmitResult::Accepted);
+    manager.Update(0.005f);
+    CHECK_EQ(activeName(manager), std::string("fire"));
+
+    std::this_thread::sleep_for(milliseconds(300));
+    AnimationRequest doorbell = requestFor(manager, {"sparkle"}, milliseconds(300), 5);
+    CHECK(manager.Submit(doorbell) == AnimationManager::SubmitResult::Accepted);
+    manager.Update(0.005f);
+    auto interruptedAt = std::chrono::steady_clock::now();
+    CHECK_EQ(activeName(manager), std::string("sparkle"));
+    CHECK_EQ(manager.CurrentStatus().activeRequest, doorbell.id);
+    CHECK_EQ(manager.CurrentStatus().queued, 2u);
+
+    // Fire comes back after the doorbell, ahead of the equal priority request that came later
+    CHECK(updateUntil(manager, [&]() { return activeName(manager) != "sparkle"; }, milliseconds(2000)));
+    CHECK_EQ(activeName(manager), std::string("fire"));
+    CHECK_EQ(manager.CurrentStatus().activeRequest, background.id);
+    auto resumedAt = std::chrono::steady_clock::now();
+    CHECK(resumedAt - interruptedAt >= milliseconds(280));
+
+    // ...for what it had left, about 500 ms, not another 800 ms
+    CHECK(updateUntil(manager, [&]() { return activeName(manager) != "fire"; }, milliseconds(2000)));
+    auto resumedFor = std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() - resumedAt);
+    auto playedBefore = std::chrono::duration_cast<milliseconds>(interruptedAt - backgroundStart);
+    std::cout << "Interrupted after " << playedBefore.count() << " ms, resumed for " << resumedFor.count()
+              << " ms of 800 ms" << std::endl;
+    CHECK(resumedFor.count() >= 800 - playedBefore.count() - 50);
+    CHECK(resumedFor.count() < 800 - playedBefore.count() + 200);
+
+    CHECK_EQ(activeName(manager), std::string("starfield"));
+    CHECK_EQ(manager.CurrentStatus().activeRequest, sameRank.id);
+    CHECK(updateUntil(manager, [&]() { return !manager.IsActive(); }, milliseconds(2000)));
+}
+
+void testPlaylistPlaysInOrder() {
+    AnimationManager manager(64, 32, 0);
+    const std::vector<std::string> playlist = {"rainbow_cycle", "starfield", "fire", "starfield"};
+    AnimationRequest request = requestFor(manager, playlist, milliseconds(100));
+    CHECK(manager.Submit(request) == AnimationManager::SubmitResult::Accepted);
+
+    std::vector<std::string> played;
+    std::string last;
+    auto start = std::chrono::steady_clock::now();
+    updateUntil(manager,
+                [&]() {
+                    std::string name = activeName(manager);
+                    if (name != last) {
+                        if (!name.empty()) {
+                            played.push_back(name);
+                            CHECK_EQ(manager.CurrentStatus().activeRequest, request.id);
+                        }
+                        last = name;
+                    }
+                    return name.empty();
+                },
+                milliseconds(3000));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(played == playlist);
+    CHECK(!manager.IsActive());
+    CHECK(elapsed >= milliseconds(390));
+    // Back on the clock face, with nothing left
+    AnimationManager::Status status = manager.CurrentStatus();
+    CHECK(!status.active.has_value());
+    CHECK_EQ(status.activeRequest, 0u);
+    CHECK_EQ(status.queued, 0u);
+}
+
+// The render thread plays requests while another thread reads the status. Active animation and
+// request come from one atomic, so a reader never pairs one request's animation with another's id.
+void testStatusSnapshot() {
+    AnimationManager manager(64, 32, 0);
+    AnimationRequest first = requestFor(manager, {"fire"}, milliseconds(150));
+    AnimationRequest second = requestFor(manager, {"swirl", "wave_lines"}, milliseconds(150));
+    CHECK(manager.Submit(first) == AnimationManager::SubmitResult::Accepted);
+    CHECK(manager.Submit(second) == AnimationManager::SubmitResult::Accepted);
+    const size_t fire = manager.FindAnimation("fire").value();
+    const size_t swirl = manager.FindAnimation("swirl").value();
+    const size_t waveLines = manager.FindAnimation("wave_lines").value();
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_acquire)) {
+            AnimationManager::Status status = manager.CurrentStatus();
+            bool consistent;
+            if (!status.active.has_value()) {
+                consistent = status.activeRequest == 0 && status.queued <= 2;
+            } else if (status.activeRequest == first.id) {
+                consistent = status.active.value() == fire && status.queued == 1;
+            } else if (status.activeRequest == second.id) {
+                size_t active = status.active.value();
+                consistent = (active == swirl || active == waveLines) && status.queued == 0;
+            } else {
+                consistent = false;
+            }
+            mismatches += !consistent;
+            reads++;
+        }
+    });
+
+    // The render thread's own view agrees with what it published
+    bool agreed = true;
+    updateUntil(manager,
+                [&]() {
+                    AnimationManager::Status status = manager.CurrentStatus();
+                    if (status.active.has_value() != manager.IsActive() ||
+                        (manager.IsActive() && manager.AnimationName(status.active.value()) != activeName(manager))) {
+                        agreed = false;
+                    }
+                    return !manager.IsActive();
+                },
+                milliseconds(3000));
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    CHECK(agreed);
+    CHECK(reads.load() > 0);
+    CHECK_EQ(mismatches.load(), 0u);
+    CHECK(!manager.CurrentStatus().active.has_value());
+}
+
+}  // namespace
+
+int main() {
+    testQueueCapacity();
+    testConcurrentProducers();
+    testSubmitRejectsWhenFull();
+    testPriorityInterruptResumes();
+    testPlaylistPlaysInOrder();
+    testStatusSnapshot();
+
+    if (checks::failures() == 0) {
+        std::cout << "animation_queue_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
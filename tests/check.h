@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+
+// Just enough of a test framework for the test executables: a failed CHECK prints where it was
+// and is counted, and main() returns checks::failures() so ctest sees the result.
+namespace checks {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+}  // namespace checks
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cout << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            checks::failures()++; \
+        } \
+    } while (0)
+
+// CHECK(a == b), printing both values when they differ
+#define CHECK_EQ(a, b) \
+    do { \
+        auto checkA_ = (a); \
+        auto checkB_ = (b); \
+        if (!(checkA_ == checkB_)) { \
+            std::cout << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " \
+                      << checkA_ << " != " << checkB_ << std::endl; \
+            checks::failures()++; \
+        } \
+    } while (0)
@@ -0,0 +1,151 @@
+// The Prometheus text ClockMetrics renders for its histograms. Samples are placed on and around
+// every exported bucket boundary, then each rendered `le` is checked against the samples it
+// counts: every sample at or below the label, and none above it. Also the +Inf bucket, _count
+// and _sum, and the order of the boundaries.
+
+#include "check.h"
+
+#include "metrics/clock_metrics.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ClockMetrics reads the frame counters of a MatrixOutput, which is never started here; the
+// driver only has to link
+MatrixDriver::MatrixDriver(int*, char***, int width, int height) : width(width), height(height) {}
+MatrixDriver::~MatrixDriver() {}
+void MatrixDriver::writeFrame(const uint8_t*, int, bool, const ColorLut &) {}
+void MatrixDriver::flipBuffer() {}
+
+namespace {
+
+struct Bucket {
+    std::string le;
+    uint64_t count = 0;
+};
+
+// The value of `name{labels}` lines, in order, for one histogram in the exposition text
+std::vector<Bucket> bucketsIn(const std::string &text, const std::string &prefix) {
+    std::vector<Bucket> buckets;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        size_t le = line.find("le=\"");
+        size_t close = line.find("\"}", le);
+        if (le == std::string::npos || close == std::string::npos) {
+            continue;
+        }
+        Bucket bucket;
+        bucket.le = line.substr(le + 4, close - le - 4);
+        bucket.count = std::strtoull(line.c_str() + close + 3, nullptr, 10);
+        buckets.push_back(bucket);
+    }
+    return buckets;
+}
+
+// The sample value of the line that starts with `prefix`, or -1 if there is none
+double valueOf(const std::string &text, const std::string &prefix) {
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            return std::strtod(line.c_str() + prefix.size(), nullptr);
+        }
+    }
+    return -1;
+}
+
+void testBucketBoundaries() {
+    FrameTimings timings;
+    MatrixDriver driver(nullptr, nullptr, 1, 1);
+    MatrixOutput output(driver, 1, 1);
+    ClockMetrics metrics(timings, output);
+
+    // Each side of and exactly on every exported boundary, plus the ends of the range
+    std::vector<uint64_t> samples = {0, 1, 3, 4, 40000000, UINT32_MAX};
+    for (int power = 4; power <= 24; power++) {
+        uint64_t boundary = 1ull << power;
+        samples.push_back(boundary - 2);
+        samples.push_back(boundary - 1);
+        samples.push_back(boundary);
+        samples.push_back(boundary + 1);
+    }
+    uint64_t sumMicros = 0;
+    for (uint64_t micros : samples) {
+        timings.record(FrameStage::Draw, std::chrono::microseconds(micros));
+        sumMicros += micros;
+    }
+
+    std::string text = metrics.toPrometheus();
+    std::vector<Bucket> buckets = bucketsIn(text, "led_clock_stage_seconds_bucket{stage=\"draw\",");
+    CHECK_EQ(buckets.size(), (size_t)22);
+    if (buckets.size() != 22) {
+        return;
+    }
+
+    double previous = -1;
+    for (size_t i = 0; i + 1 < buckets.size(); i++) {
+        // Printed exactly, so the label is (2^p - 1) us to the microsecond
+        double le = std::strtod(buckets[i].le.c_str(), nullptr);
+        uint64_t limitMicros = (1ull << (i + 4)) - 1;
+        CHECK_EQ(le, limitMicros / 1e6);
+        CHECK(le > previous);
+        previous = le;
+
+        uint64_t expected = 0;
+        for (uint64_t micros : samples) {
+            expected += micros / 1e6 <= le;
+        }
+        if (buckets[i].count != expected) {
+            std::cout << "le=\"" << buckets[i].le << "\" counts " << buckets[i].count << " samples, " << expected
+                      << " are at or below it" << std::endl;
+            checks::failures()++;
+        }
+    }
+    CHECK_EQ(buckets.back().le, std::string("+Inf"));
+    CHECK_EQ(buckets.back().count, (uint64_t)samples.size());
+    CHECK_EQ(valueOf(text, "led_clock_stage_seconds_count{stage=\"draw\"} "), (double)samples.size());
+    double sum = valueOf(text, "led_clock_stage_seconds_sum{stage=\"draw\"} ");
+    CHECK(sum > sumMicros / 1e6 * 0.9999 && sum < sumMicros / 1e6 * 1.0001);
+
+    // A histogram with no samples still renders every bucket, all zero
+    std::vector<Bucket> empty = bucketsIn(text, "led_clock_stage_seconds_bucket{stage=\"flip\",");
+    CHECK_EQ(empty.size(), (size_t)22);
+    for (const Bucket &bucket : empty) {
+        CHECK_EQ(bucket.count, 0u);
+    }
+    CHECK_EQ(valueOf(text, "led_clock_weather_fetch_seconds_count{} "), 0.0);
+    CHECK(text.find("led_clock_weather_fetch_seconds_bucket{le=\"1.5e-05\"} 0\n") != std::string::npos);
+}
+
+void testHistogramRange() {
+    // The last bucket ends at 2^25 us and also takes everything longer
+    CHECK_EQ(LatencyHistogram::bucketUpperBound(LatencyHistogram::kBucketCount - 1), (1u << 25) - 1);
+    CHECK_EQ(LatencyHistogram::bucketFor((1u << 25) - 1), LatencyHistogram::kBucketCount - 1);
+    CHECK_EQ(LatencyHistogram::bucketFor(UINT32_MAX), LatencyHistogram::kBucketCount - 1);
+    // Every bucket starts right after the one before it
+    for (int i = 0; i + 1 < LatencyHistogram::kBucketCount; i++) {
+        uint32_t upper = LatencyHistogram::bucketUpperBound(i);
+        CHECK_EQ(LatencyHistogram::bucketFor(upper), i);
+        CHECK_EQ(LatencyHistogram::bucketFor(upper + 1), i + 1);
+    }
+}
+
+}  // namespace
+
+int main() {
+    testBucketBoundaries();
+    testHistogramRange();
+
+    if (checks::failures() == 0) {
+        std::cout << "clock_metrics_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
@@ -0,0 +1,196 @@
+// FrameRecorder and FrameRecordingReader: frames written through the recorder have to come back
+// byte for byte, whichever encoding the recorder picked for them. The sequence covers a first
+// frame (always raw), identical frames (an empty delta), single pixels, runs at both ends of the
+// frame, a frame where everything changed (raw again) and, on a large frame, unchanged stretches
+// longer than one u16 run. Recordings are written to the working directory and removed after.
+
+#include "check.h"
+
+#include "output/frame_recording.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Frame = std::vector<uint8_t>;
+
+// The encoding of each frame in the file, read straight from the frame headers
+std::vector<int> encodingsIn(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<int> encodings;
+    size_t offset = 10;
+    while (offset + 13 <= bytes.size()) {
+        int encoding = bytes[offset + 8];
+        uint32_t size = bytes[offset + 9] | bytes[offset + 10] << 8 | bytes[offset + 11] << 16
+                        | (uint32_t)bytes[offset + 12] << 24;
+        encodings.push_back(encoding);
+        offset += 13 + size;
+    }
+    CHECK_EQ(offset, bytes.size());
+    return encodings;
+}
+
+void writeRecording(const std::string &path, int width, int height, const std::vector<Frame> &frames) {
+    FrameRecorder recorder(path, width, height);
+    CHECK(recorder.isOpen());
+    for (const Frame &frame : frames) {
+        recorder.writeFrame(frame.data());
+    }
+    CHECK_EQ(recorder.framesWritten(), (uint64_t)frames.size());
+}
+
+// Reads the recording back and compares each frame with what was written
+void checkRoundTrip(const std::string &path, int width, int height, const std::vector<Frame> &frames) {
+    FrameRecordingReader reader(path);
+    CHECK(reader.isOpen());
+    CHECK_EQ(reader.width(), width);
+    CHECK_EQ(reader.height(), height);
+    uint64_t timestamp = 0;
+    uint64_t previousTimestamp = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (!reader.readFrame(timestamp)) {
+            std::cout << path << ": frame " << i << " did not decode" << std::endl;
+            checks::failures()++;
+            return;
+        }
+        if (!std::equal(frames[i].begin(), frames[i].end(), reader.frame())) {
+            std::cout << path << ": frame " << i << " differs from what was written" << std::endl;
+            checks::failures()++;
+        }
+        CHECK(timestamp >= previousTimestamp);
+        previousTimestamp = timestamp;
+    }
+    CHECK(!reader.readFrame(timestamp));
+}
+
+void testSmallFrames() {
+    const int width = 64;
+    const int height = 32;
+    const size_t bytes = width * height * 3;
+    std::mt19937 rng(7);
+    std::vector<Frame> frames;
+
+    Frame frame(bytes, 0);
+    frames.push_back(frame);
+    // Identical twice over
+    frames.push_back(frame);
+    frames.push_back(frame);
+    // One pixel in the middle, then the first and the last pixel
+    frame[(16 * width + 20) * 3 + 1] = 200;
+    frames.push_back(frame);
+    frame[0] = 1;
+    frame[bytes - 1] = 2;
+    frames.push_back(frame);
+    // A few runs of changed pixels, as the clock digits would make
+    for (int run = 0; run < 5; run++) {
+        int start = rng() % (width * height - 40);
+        for (int pixel = start; pixel < start + 1 + (int)(rng() % 40); pixel++) {
+            frame[pixel * 3] = rng();
+        }
+    }
+    frames.push_back(frame);
+    // Everything changes, which a delta cannot beat
+    for (uint8_t &byte : frame) {
+        byte = rng() | 1;
+    }
+    frames.push_back(frame);
+    frames.push_back(frame);
+    // Every other pixel changes, so the delta would be bigger than the frame
+    for (int pixel = 0; pixel < width * height; pixel += 2) {
+        frame[pixel * 3 + 2] ^= 0xff;
+    }
+    frames.push_back(frame);
+
+    const std::string path = "frame_recording_test_small.lmcr";
+    writeRecording(path, width, height, frames);
+    checkRoundTrip(path, width, height, frames);
+
+    using namespace frame_recording;
+    const std::vector<int> expected = {kEncodingRaw,   kEncodingDelta, kEncodingDelta,
+                                       kEncodingDelta, kEncodingDelta, kEncodingDelta,
+                                       kEncodingRaw,   kEncodingDelta, kEncodingRaw};
+    CHECK(encodingsIn(path) == expected);
+
+    // A recording cut off in the last frame still gives every frame before it
+    std::ifstream in(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string cutPath = "frame_recording_test_cut.lmcr";
+    std::ofstream(cutPath, std::ios::binary).write(contents.data(), contents.size() - 100);
+    FrameRecordingReader cut(cutPath);
+    uint64_t timestamp = 0;
+    for (size_t i = 0; i + 1 < frames.size(); i++) {
+        CHECK(cut.readFrame(timestamp));
+    }
+    CHECK(!cut.readFrame(timestamp));
+
+    std::remove(path.c_str());
+    std::remove(cutPath.c_str());
+}
+
+void testLongRuns() {
+    // 100000 pixels, more than a u16 run can keep or change in one go
+    const int width = 400;
+    const int height = 250;
+    const int pixels = width * height;
+    std::vector<Frame> frames;
+
+    Frame frame(pixels * 3, 10);
+    frames.push_back(frame);
+    // Only the last pixel changes: the unchanged stretch before it needs two runs
+    frame[(pixels - 1) * 3] = 11;
+    frames.push_back(frame);
+    // 70000 changed pixels after an unchanged start, still smaller than raw as a delta
+    for (int pixel = 1000; pixel < 71000; pixel++) {
+        frame[pixel * 3 + 1] = 12;
+    }
+    frames.push_back(frame);
+    frames.push_back(frame);
+
+    const std::string path = "frame_recording_test_long.lmcr";
+    writeRecording(path, width, height, frames);
+    checkRoundTrip(path, width, height, frames);
+    using namespace frame_recording;
+    const std::vector<int> expected = {kEncodingRaw, kEncodingDelta, kEncodingDelta, kEncodingDelta};
+    CHECK(encodingsIn(path) == expected);
+    std::remove(path.c_str());
+}
+
+void testEmptyAndInvalid() {
+    // A header and no frames opens, but has nothing to read
+    const std::string path = "frame_recording_test_empty.lmcr";
+    { FrameRecorder recorder(path, 64, 32); }
+    FrameRecordingReader empty(path);
+    CHECK(empty.isOpen());
+    uint64_t timestamp = 0;
+    CHECK(!empty.readFrame(timestamp));
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "LMCX not a recording";
+    FrameRecordingReader invalid(path);
+    CHECK(!invalid.isOpen());
+    CHECK(!invalid.readFrame(timestamp));
+    std::remove(path.c_str());
+
+    FrameRecordingReader missing("frame_recording_test_missing.lmcr");
+    CHECK(!missing.isOpen());
+}
+
+}  // namespace
+
+int main() {
+    testSmallFrames();
+    testLongRuns();
+    testEmptyAndInvalid();
+
+    if (checks::failures() == 0) {
+        std::cout << "frame_recording_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
@@ -0,0 +1,205 @@
+// parseOpenMeteoForecast() (the streaming SAX decoder) against the DOM decoder it replaced, on
+// the responses in tests/data, then a timing of both. Every hour and half hour across the
+// series is tried as "now", so the 24-hour window starts at each position, including past the end.
+//
+//   led_matrix_open_meteo_test <tests/data directory> [iterations]
+
+#include "check.h"
+
+#include "weather/open_meteo.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+using json = nlohmann::json;
+
+// The decoder parseOpenMeteoForecast() used before it streamed: parse the whole body into a
+// DOM, copy the hourly series into vectors and walk them
+bool parseWithDom(const std::string &body, uint64_t nowMillis, Forecast &forecast) {
+    Forecast decoded = forecast;
+    try {
+        json rawPayload = json::parse(body);
+        auto &currentWeather = rawPayload["current_weather"];
+        std::vector<double> temperatureData = rawPayload["hourly"]["temperature_2m"];
+        std::vector<uint64_t> timestamps = rawPayload["hourly"]["time"];
+        uint64_t nowSeconds = nowMillis / 1000;
+        for (size_t i = 0; i < timestamps.size() && i < temperatureData.size(); i++) {
+            if (timestamps[i] >= nowSeconds) {
+                int hourRelative = (int)((timestamps[i] - nowSeconds) / 3600.0);
+                if (hourRelative < Forecast::kHours) {
+                    decoded.temperatures[hourRelative] = (int)temperatureData[i];
+                }
+            }
+        }
+        decoded.temperatures[0] = (int)currentWeather["temperature"].get<double>();
+        decoded.weatherCode = currentWeather["weathercode"];
+        decoded.sunriseMillis = rawPayload["daily"]["sunrise"][0].get<uint64_t>() * 1000;
+        decoded.sunsetMillis = rawPayload["daily"]["sunset"][0].get<uint64_t>() * 1000;
+    } catch (std::exception &) {
+        return false;
+    }
+    forecast = decoded;
+    return true;
+}
+
+// parseOpenMeteoForecast() logs what it decoded; keep that out of the test output
+bool parseQuietly(const std::string &body, uint64_t nowMillis, Forecast &forecast) {
+    std::streambuf* original = std::cout.rdbuf(nullptr);
+    bool parsed = parseOpenMeteoForecast(body, nowMillis, forecast);
+    std::cout.rdbuf(original);
+    std::cout.clear();
+    return parsed;
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+// Hours the response does not cover keep what the forecast held before, so start from values
+// neither decoder could produce
+Forecast sentinelForecast() {
+    Forecast forecast;
+    for (int i = 0; i < Forecast::kHours; i++) {
+        forecast.temperatures[i] = -1000 - i;
+    }
+    return forecast;
+}
+
+bool sameDecodedFields(const Forecast &a, const Forecast &b) {
+    return a.temperatures == b.temperatures && a.weatherCode == b.weatherCode &&
+           a.sunriseMillis == b.sunriseMillis && a.sunsetMillis == b.sunsetMillis;
+}
+
+// `streamed` is decoded by parseOpenMeteoForecast(), `reference` (the same data, possibly in
+// another field order) by the DOM decoder
+void checkEquivalent(const std::string &streamed, const std::string &reference) {
+    json payload = json::parse(reference);
+    uint64_t first = payload["hourly"]["time"].front();
+    uint64_t last = payload["hourly"]["time"].back();
+    int compared = 0;
+    for (uint64_t now = first - 2 * 3600; now <= last + 3600; now += 1800) {
+        Forecast sax = sentinelForecast();
+        Forecast dom = sentinelForecast();
+        bool saxParsed = parseQuietly(streamed, now * 1000, sax);
+        bool domParsed = parseWithDom(reference, now * 1000, dom);
+        CHECK(saxParsed);
+        CHECK(domParsed);
+        if (!sameDecodedFields(sax, dom)) {
+            std::cout << "Decoders disagree at now = " << now << std::endl;
+            checks::failures()++;
+        }
+        compared++;
+    }
+    CHECK(compared > 300);
+}
+
+void checkMissingFields(const std::string &body) {
+    json payload = json::parse(body);
+    uint64_t now = payload["current_weather"]["time"];
+    // Each of these is needed; dropping any one must fail both decoders and leave the forecast alone
+    const std::vector<std::vector<std::string>> required = {
+        {"current_weather"},
+        {"current_weather", "temperature"},
+        {"current_weather", "weathercode"},
+        {"hourly"},
+        {"hourly", "time"},
+        {"hourly", "temperature_2m"},
+        {"daily"},
+        {"daily", "sunrise"},
+        {"daily", "sunset"},
+    };
+    for (const auto &path : required) {
+        json trimmed = payload;
+        json* parent = &trimmed;
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+            parent = &(*parent)[path[i]];
+        }
+        parent->erase(path.back());
+
+        Forecast sax = sentinelForecast();
+        Forecast dom = sentinelForecast();
+        bool saxParsed = parseQuietly(trimmed.dump(), now * 1000, sax);
+        bool domParsed = parseWithDom(trimmed.dump(), now * 1000, dom);
+        if (saxParsed || domParsed) {
+            std::cout << "Parsed without " << path.back() << std::endl;
+            checks::failures()++;
+        }
+        CHECK(sameDecodedFields(sax, sentinelForecast()));
+    }
+
+    // Present but empty is as good as missing
+    json noSunrise = payload;
+    noSunrise["daily"]["sunrise"] = json::array();
+    Forecast forecast = sentinelForecast();
+    CHECK(!parseQuietly(noSunrise.dump(), now * 1000, forecast));
+    CHECK(!parseWithDom(noSunrise.dump(), now * 1000, forecast));
+
+    // Cut off mid-response
+    std::string truncated = body.substr(0, body.size() / 2);
+    CHECK(!parseQuietly(truncated, now * 1000, forecast));
+    CHECK(!parseWithDom(truncated, now * 1000, forecast));
+    CHECK(sameDecodedFields(forecast, sentinelForecast()));
+}
+
+template <typename Parse>
+double microsPerParse(const std::string &body, uint64_t nowMillis, int iterations, Parse parse) {
+    Forecast forecast;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        parse(body, nowMillis, forecast);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void benchmark(const std::string &body, int iterations) {
+    json payload = json::parse(body);
+    uint64_t nowMillis = payload["current_weather"]["time"].get<uint64_t>() * 1000;
+    double dom = microsPerParse(body, nowMillis, iterations, parseWithDom);
+    double sax = microsPerParse(body, nowMillis, iterations, parseQuietly);
+    std::cout << "Decoding " << body.size() << " bytes, " << iterations << " iterations: DOM " << dom
+              << " us, streaming " << sax << " us per parse" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <tests/data directory> [iterations]" << std::endl;
+        return 2;
+    }
+    std::string dataDir = argv[1];
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::string forecast = readFile(dataDir + "/open_meteo_forecast.json");
+    // The same response with daily first, current_weather last and temperature_2m ahead of time,
+    // so the decoder has to hold the temperatures until it knows which hours they belong to
+    std::string temperaturesFirst = readFile(dataDir + "/open_meteo_forecast_temperatures_first.json");
+    CHECK(!forecast.empty());
+    CHECK(!temperaturesFirst.empty());
+    if (checks::failures() > 0) {
+        return checks::failures();
+    }
+
+    checkEquivalent(forecast, forecast);
+    checkEquivalent(temperaturesFirst, forecast);
+    checkMissingFields(forecast);
+    checkMissingFields(temperaturesFirst);
+    benchmark(forecast, iterations);
+
+    if (checks::failures() == 0) {
+        std::cout << "open_meteo_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
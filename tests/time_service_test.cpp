@@ -0,0 +1,175 @@
+// TimeService::at() against localtime_r() in zones with awkward transitions. TZ is set for each
+// zone in turn. The times tried are every second around each transition in 2024-2026, sweeps across
+// those years both in order (so the cached window is reused) and out of order (so it is
+// recomputed), and every midnight.
+//
+//   America/New_York     the clock's own zone
+//   Europe/London        transitions at 01:00 UTC
+//   America/Santiago     transitions at midnight: 23:59:59 is followed by 01:00, or by 23:00 again
+//   America/Havana       transitions at midnight: 00:00 becomes 01:00, and 01:00 goes back to 00:00
+//   Australia/Lord_Howe  a 30 minute DST shift
+//   Asia/Kolkata         a half hour offset and no DST
+//   Pacific/Chatham      a 45 minute offset with DST
+
+#include "check.h"
+
+#include "time/time_service.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace {
+
+// 2024-01-01 and 2027-01-01, 00:00 UTC
+const std::time_t kRangeStart = 1704067200;
+const std::time_t kRangeEnd = 1798761600;
+
+void setZone(const char* zone) {
+    setenv("TZ", zone, 1);
+    tzset();
+}
+
+long offsetAt(std::time_t t) {
+    std::tm local;
+    localtime_r(&t, &local);
+    return local.tm_gmtoff;
+}
+
+int dayOfMonth(std::time_t t) {
+    std::tm local;
+    localtime_r(&t, &local);
+    return local.tm_mday;
+}
+
+// Every second at which the UTC offset changes in [from, to)
+std::vector<std::time_t> transitions(std::time_t from, std::time_t to) {
+    std::vector<std::time_t> found;
+    for (std::time_t hour = from; hour + 3600 <= to; hour += 3600) {
+        long before = offsetAt(hour);
+        if (offsetAt(hour + 3600) == before) {
+            continue;
+        }
+        std::time_t low = hour;
+        std::time_t high = hour + 3600;
+        while (high - low > 1) {
+            std::time_t middle = low + (high - low) / 2;
+            (offsetAt(middle) == before ? low : high) = middle;
+        }
+        found.push_back(high);
+    }
+    return found;
+}
+
+// Compares every field of `time` with what libc says about the same second, and reports the first
+// mismatch per zone so a broken window does not flood the log
+bool matchesLibc(const char* zone, const CivilTime &time) {
+    std::tm local;
+    std::time_t t = time.epochSecond;
+    localtime_r(&t, &local);
+    char date[16];
+    std::strftime(date, sizeof(date), "%b %e", &local);
+    bool same = time.year == local.tm_year + 1900 && time.month == local.tm_mon + 1 &&
+                time.day == local.tm_mday && time.weekday == local.tm_wday &&
+                time.hour == local.tm_hour && time.minute == local.tm_min &&
+                time.second == local.tm_sec && time.utcOffset == local.tm_gmtoff &&
+                time.secondOfDay == local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec &&
+                std::strcmp(time.date, date) == 0;
+    if (!same) {
+        char expected[64];
+        std::strftime(expected, sizeof(expected), "%Y-%m-%d %H:%M:%S %z", &local);
+        std::cout << zone << " at " << (long long)t << ": expected " << expected << " (" << date << "), got "
+                  << time.year << "-" << time.month << "-" << time.day << " " << time.hour << ":"
+                  << time.minute << ":" << time.second << " offset " << time.utcOffset << " ("
+                  << time.date << ")" << std::endl;
+        checks::failures()++;
+    }
+    return same;
+}
+
+void checkZone(const char* zone, bool hasDst) {
+    struct stat info;
+    if (stat((std::string("/usr/share/zoneinfo/") + zone).c_str(), &info) != 0) {
+        // Without the zone file libc silently falls back to UTC, which would prove nothing
+        std::cout << "Skipping " << zone << ": not in /usr/share/zoneinfo" << std::endl;
+        return;
+    }
+    setZone(zone);
+    std::vector<std::time_t> changes = transitions(kRangeStart, kRangeEnd);
+    if (hasDst) {
+        CHECK(changes.size() >= 6);
+    } else {
+        CHECK(changes.empty());
+    }
+
+    // Second by second through each transition, coming from well before it
+    for (std::time_t change : changes) {
+        TimeService service;
+        for (std::time_t t = change - 2 * 3600; t <= change + 2 * 3600; t++) {
+            if (!matchesLibc(zone, service.at(t))) {
+                return;
+            }
+        }
+    }
+
+    // In order across the whole range, at an odd stride so the seconds vary; the window should
+    // only be rebuilt about once a day plus once per transition
+    TimeService sequential;
+    for (std::time_t t = kRangeStart; t < kRangeEnd; t += 7919) {
+        if (!matchesLibc(zone, sequential.at(t))) {
+            return;
+        }
+    }
+    unsigned long days = (kRangeEnd - kRangeStart) / 86400;
+    CHECK(sequential.recomputations() <= days + changes.size() + 1);
+
+    // Out of order, so windows are left backwards and forwards
+    TimeService random;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<std::time_t> anywhere(kRangeStart, kRangeEnd);
+    for (int i = 0; i < 20000; i++) {
+        if (!matchesLibc(zone, random.at(anywhere(rng)))) {
+            return;
+        }
+    }
+
+    // Each side of every change of date. Where midnight itself is skipped, that is 23:59:59 and
+    // 01:00:00.
+    TimeService midnights;
+    for (std::time_t t = kRangeStart; t + 3600 <= kRangeEnd; t += 3600) {
+        if (dayOfMonth(t) == dayOfMonth(t + 3600)) {
+            continue;
+        }
+        std::time_t low = t;
+        std::time_t high = t + 3600;
+        while (high - low > 1) {
+            std::time_t middle = low + (high - low) / 2;
+            (dayOfMonth(middle) == dayOfMonth(t) ? low : high) = middle;
+        }
+        if (!matchesLibc(zone, midnights.at(high - 1)) || !matchesLibc(zone, midnights.at(high))) {
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    checkZone("America/New_York", true);
+    checkZone("Europe/London", true);
+    checkZone("America/Santiago", true);
+    checkZone("America/Havana", true);
+    checkZone("Australia/Lord_Howe", true);
+    checkZone("Asia/Kolkata", false);
+    checkZone("Pacific/Chatham", true);
+    checkZone("UTC", false);
+
+    if (checks::failures() == 0) {
+        std::cout << "time_service_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
@@ -0,0 +1,141 @@
+// TripleBuffer, first single-threaded for the latest-wins and drop accounting, then with a
+// producer and a consumer thread hammering it the way the render and output threads do. Every
+// frame is filled with its sequence number, so a slot read while it is being written shows up as
+// a frame whose words disagree.
+//
+//   led_matrix_triple_buffer_test [frames]
+
+#include "check.h"
+
+#include "output/triple_buffer.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// About the size of a 64x32 RGBA frame, so a copy takes long enough for a torn read to be likely
+// if the handoff were wrong
+using Frame = std::array<uint64_t, 1024>;
+
+void fill(Frame &frame, uint64_t sequence) {
+    frame.fill(sequence);
+}
+
+// The sequence number the frame was filled with, or ~0 if its words disagree
+uint64_t sequenceOf(const Frame &frame) {
+    for (uint64_t word : frame) {
+        if (word != frame[0]) {
+            return ~0ull;
+        }
+    }
+    return frame[0];
+}
+
+void testLatestWins() {
+    TripleBuffer<Frame> buffer;
+    fill(buffer.writeBuffer(), 0);
+    buffer.publish();
+    CHECK(buffer.acquire());
+    fill(buffer.writeBuffer(), 99);
+
+    // Nothing new: acquire() fails and the read slot keeps the last frame
+    CHECK(!buffer.acquire());
+    CHECK_EQ(sequenceOf(buffer.readBuffer()), 0ull);
+
+    // Three frames before the consumer looks: the first publish replaces nothing, the next two
+    // each replace a frame that was never seen, and only the last is read
+    fill(buffer.writeBuffer(), 1);
+    CHECK(buffer.publish());
+    fill(buffer.writeBuffer(), 2);
+    CHECK(!buffer.publish());
+    fill(buffer.writeBuffer(), 3);
+    CHECK(!buffer.publish());
+    CHECK(buffer.acquire());
+    CHECK_EQ(sequenceOf(buffer.readBuffer()), 3ull);
+    CHECK(!buffer.acquire());
+    CHECK_EQ(sequenceOf(buffer.readBuffer()), 3ull);
+
+    // The producer never gets the slot the consumer is reading
+    for (uint64_t sequence = 4; sequence < 20; sequence++) {
+        CHECK(&buffer.writeBuffer() != &buffer.readBuffer());
+        fill(buffer.writeBuffer(), sequence);
+        buffer.publish();
+        if (sequence % 3 == 0) {
+            CHECK(buffer.acquire());
+            CHECK_EQ(sequenceOf(buffer.readBuffer()), sequence);
+        }
+    }
+}
+
+void testTwoThreads(uint64_t frames) {
+    TripleBuffer<Frame> buffer;
+    std::atomic<bool> producerDone{false};
+    uint64_t replaced = 0;
+
+    std::thread producer([&]() {
+        for (uint64_t sequence = 1; sequence <= frames; sequence++) {
+            fill(buffer.writeBuffer(), sequence);
+            if (!buffer.publish()) {
+                replaced++;
+            }
+            // Otherwise the producer laps the consumer so fast that almost every frame is replaced
+            if (sequence % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    uint64_t seen = 0;
+    uint64_t last = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    auto consume = [&]() {
+        if (!buffer.acquire()) {
+            return;
+        }
+        uint64_t sequence = sequenceOf(buffer.readBuffer());
+        if (sequence == ~0ull) {
+            torn++;
+            return;
+        }
+        if (sequence <= last) {
+            backwards++;
+        }
+        last = sequence;
+        seen++;
+    };
+    while (!producerDone.load(std::memory_order_acquire)) {
+        consume();
+    }
+    // Whatever was published last is still waiting
+    consume();
+    producer.join();
+
+    CHECK_EQ(torn, 0ull);
+    CHECK_EQ(backwards, 0ull);
+    // The newest frame always gets through, and every frame was either read or replaced
+    CHECK_EQ(last, frames);
+    CHECK_EQ(seen + replaced, frames);
+    CHECK(!buffer.acquire());
+    std::cout << frames << " frames: " << seen << " read, " << replaced << " replaced before they were read"
+              << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint64_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    testLatestWins();
+    testTwoThreads(frames);
+
+    if (checks::failures() == 0) {
+        std::cout << "triple_buffer_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}
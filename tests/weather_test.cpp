@@ -0,0 +1,452 @@
+// PollSchedule, WeatherOptions, the forecast cache and WeatherService. The service runs against a
+// stub HTTP server on 127.0.0.1 that answers each path differently: good forecasts, slow ones,
+// server errors, a response slower than the request timeout, malformed JSON and conditional
+// requests. Cache files are written to the working directory and removed after.
+
+#include "check.h"
+
+#include "metrics/clock_metrics.h"
+#include "third_party/httplib.h"
+#include "weather/forecast_cache.h"
+#include "weather/poll_schedule.h"
+#include "weather/weather_service.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+// ClockMetrics reads the frame counters of a MatrixOutput, which is never started here; the
+// driver only has to link
+MatrixDriver::MatrixDriver(int*, char***, int width, int height) : width(width), height(height) {}
+MatrixDriver::~MatrixDriver() {}
+void MatrixDriver::writeFrame(const uint8_t*, int, bool, const ColorLut &) {}
+void MatrixDriver::flipBuffer() {}
+
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+uint64_t nowSeconds() {
+    using namespace std::chrono;
+    return duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// An open-meteo style response whose hourly series covers the current time
+std::string forecastBody(int currentTemperature) {
+    uint64_t hour = nowSeconds() / 3600 * 3600;
+    nlohmann::json times = nlohmann::json::array();
+    nlohmann::json temperatures = nlohmann::json::array();
+    for (int i = -2; i < 48; i++) {
+        times.push_back(hour + i * 3600);
+        temperatures.push_back(50.0 + i);
+    }
+    nlohmann::json body;
+    body["current_weather"] = {{"temperature", currentTemperature + 0.4}, {"weathercode", 61}};
+    body["hourly"] = {{"time", times}, {"temperature_2m", temperatures}};
+    body["daily"] = {{"sunrise", {hour - 6 * 3600}}, {"sunset", {hour + 6 * 3600}}};
+    return body.dump();
+}
+
+bool waitFor(const std::function<bool()> &condition, milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(20));
+    }
+    return true;
+}
+
+void testPollScheduleSuccess() {
+    PollSchedule schedule(seconds(60));
+    long long low = 60000;
+    long long high = 0;
+    for (int i = 0; i < 1000; i++) {
+        long long delay = schedule.next(true).count();
+        low = std::min(low, delay);
+        high = std::max(high, delay);
+    }
+    // +/-10%, and actually spread over that range
+    CHECK(low >= 54000);
+    CHECK(high <= 66000);
+    CHECK(high - low > 6000);
+    CHECK_EQ(schedule.consecutiveFailures(), 0);
+
+    for (int i = 0; i < 100; i++) {
+        long long delay = schedule.initialDelay().count();
+        CHECK(delay >= 0 && delay <= 3000);
+    }
+}
+
+void testPollScheduleBackoff() {
+    PollSchedule schedule(seconds(60), seconds(10), seconds(100));
+    // Windows of 10, 20, 40, 80 s, then capped at 100 s; each delay in the upper half
+    const long long windows[] = {10000, 20000, 40000, 80000, 100000, 100000, 100000};
+    for (long long window : windows) {
+        long long delay = schedule.next(false).count();
+        CHECK(delay >= window / 2);
+        CHECK(delay <= window);
+    }
+    CHECK_EQ(schedule.consecutiveFailures(), 7);
+
+    // Far past the point where the doubling would overflow
+    for (int i = 0; i < 100; i++) {
+        long long delay = schedule.next(false).count();
+        CHECK(delay >= 50000 && delay <= 100000);
+    }
+
+    // One success resets the backoff
+    long long delay = schedule.next(true).count();
+    CHECK(delay >= 54000 && delay <= 66000);
+    CHECK_EQ(schedule.consecutiveFailures(), 0);
+    delay = schedule.next(false).count();
+    CHECK(delay >= 5000 && delay <= 10000);
+    CHECK_EQ(schedule.consecutiveFailures(), 1);
+}
+
+void testPollScheduleJitterSpreadsRetries() {
+    // Two clocks failing in lockstep should not retry in lockstep
+    PollSchedule a(seconds(60));
+    PollSchedule b(seconds(60));
+    int same = 0;
+    for (int i = 0; i < 20; i++) {
+        same += a.next(false) == b.next(false);
+    }
+    CHECK(same < 20);
+
+    // A maximum below the minimum is raised to it
+    PollSchedule clamped(seconds(60), seconds(10), seconds(1));
+    for (int i = 0; i < 10; i++) {
+        long long delay = clamped.next(false).count();
+        CHECK(delay >= 5000 && delay <= 10000);
+    }
+}
+
+void testIsStale() {
+    WeatherOptions options;
+    options.maxAge = seconds(7200);
+    Forecast forecast;
+    // The placeholder is always stale
+    CHECK(options.isStale(forecast, 1000));
+
+    forecast.fetchedMillis = 1000000;
+    CHECK(!options.isStale(forecast, 1000000));
+    CHECK(!options.isStale(forecast, 1000000 + 7200 * 1000));
+    CHECK(options.isStale(forecast, 1000000 + 7200 * 1000 + 1));
+}
+
+void testFromArgs() {
+    const char* argv[] = {"led_matrix_clock", "--weather-url=http://127.0.0.1:1/x", "--weather-interval=3",
+                          "--weather-max-age=oops", "--weather-timeout=2", "--weather-cache="};
+    WeatherOptions options = WeatherOptions::FromArgs(6, (char**)argv);
+    CHECK_EQ(options.url, std::string("http://127.0.0.1:1/x"));
+    // Clamped to the minimum interval
+    CHECK_EQ(options.refreshInterval.count(), 10);
+    // Ignored, so the default stays
+    CHECK_EQ(options.maxAge.count(), 7200);
+    CHECK_EQ(options.requestTimeout.count(), 2);
+    CHECK(options.cachePath.empty());
+}
+
+const uint64_t kHourMillis = 3600 * 1000;
+
+std::string readBytes(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void writeBytes(const std::string &path, const std::string &bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+}
+
+// A forecast as the decoder would leave it, fetched at `fetchedMillis`, with a different
+// temperature for every hour (some below zero) so a shift by the wrong amount shows
+Forecast cacheableForecast(uint64_t fetchedMillis) {
+    Forecast forecast;
+    for (int i = 0; i < Forecast::kHours; i++) {
+        forecast.temperatures[i] = -5 + i * 3;
+    }
+    forecast.weatherCode = 61;
+    forecast.fetchedMillis = fetchedMillis;
+    forecast.sunriseMillis = fetchedMillis - 2 * kHourMillis;
+    forecast.sunsetMillis = fetchedMillis + 10 * kHourMillis;
+    return forecast;
+}
+
+void testForecastCacheRoundTrip() {
+    const std::string path = "weather_test_cache.bin";
+    const uint64_t fetched = nowSeconds() * 1000;
+    Forecast saved = cacheableForecast(fetched);
+    CHECK(saveForecastCache(path, saved));
+    // Written through a temporary file that the rename consumed
+    CHECK(readBytes(path + ".tmp").empty());
+
+    // Straight back, as a restart within the same hour would load it
+    Forecast loaded;
+    CHECK(loadForecastCache(path, fetched + 1000, loaded));
+    CHECK(loaded.temperatures == saved.temperatures);
+    CHECK_EQ(loaded.weatherCode, 61);
+    CHECK_EQ(loaded.fetchedMillis, fetched);
+    CHECK_EQ(loaded.sunriseMillis, saved.sunriseMillis);
+    CHECK_EQ(loaded.sunsetMillis, saved.sunsetMillis);
+    CHECK(loaded.isDaytime);
+    CHECK(loaded.type == WeatherType::cloudy_rain);
+
+    // Three and a half hours later hour 0 is the fourth cached hour, and the last known hour
+    // fills in at the end
+    CHECK(loadForecastCache(path, fetched + 3 * kHourMillis + 30 * 60 * 1000, loaded));
+    for (int i = 0; i < Forecast::kHours; i++) {
+        CHECK_EQ(loaded.temperatures[i], saved.temperatures[std::min(i + 3, Forecast::kHours - 1)]);
+    }
+    CHECK_EQ(loaded.fetchedMillis, fetched);
+
+    // After sunset the same cache is a night forecast
+    CHECK(loadForecastCache(path, fetched + 11 * kHourMillis, loaded));
+    CHECK(!loaded.isDaytime);
+    CHECK_EQ(loaded.temperatures[0], saved.temperatures[11]);
+
+    // Past the next sunrise, sunrise and sunset move on a day
+    CHECK(loadForecastCache(path, fetched + 23 * kHourMillis, loaded));
+    CHECK_EQ(loaded.sunriseMillis, saved.sunriseMillis + 24 * kHourMillis);
+    CHECK_EQ(loaded.sunsetMillis, saved.sunsetMillis + 24 * kHourMillis);
+    CHECK(loaded.isDaytime);
+    for (int i = 0; i < Forecast::kHours; i++) {
+        CHECK_EQ(loaded.temperatures[i], saved.temperatures[Forecast::kHours - 1]);
+    }
+
+    // A day old, or from the future, is not used
+    Forecast untouched;
+    CHECK(!loadForecastCache(path, fetched + 24 * kHourMillis, untouched));
+    CHECK(!loadForecastCache(path, fetched - 1000, untouched));
+    CHECK_EQ(untouched.fetchedMillis, 0u);
+
+    // A restarted service shows the cached forecast before its first poll
+    WeatherOptions options;
+    options.url = "http://127.0.0.1:9/";
+    options.cachePath = path;
+    WeatherService warm(options, nullptr);
+    CHECK_EQ(warm.latest()->fetchedMillis, fetched);
+    CHECK(warm.latest()->temperatures[0] == saved.temperatures[0]);
+
+    std::remove(path.c_str());
+}
+
+void testForecastCacheRejectsDamage() {
+    const std::string path = "weather_test_cache.bin";
+    const uint64_t fetched = nowSeconds() * 1000;
+    CHECK(saveForecastCache(path, cacheableForecast(fetched)));
+    const std::string good = readBytes(path);
+    CHECK_EQ(good.size(), (size_t)(33 + Forecast::kHours * 2 + 4));
+
+    // Each of these must leave the forecast it was given alone
+    auto rejected = [&](const std::string &bytes, const char* what) {
+        writeBytes(path, bytes);
+        Forecast forecast;
+        if (loadForecastCache(path, fetched + 1000, forecast)) {
+            std::cout << "Loaded a cache with " << what << std::endl;
+            checks::failures()++;
+        }
+        CHECK_EQ(forecast.fetchedMillis, 0u);
+        CHECK_EQ(forecast.temperatures[5], 60);
+    };
+
+    rejected("", "no bytes");
+    rejected(good.substr(0, good.size() - 1), "its last byte cut off");
+    rejected(good.substr(0, good.size() / 2), "only its first half");
+    rejected(good + '\0', "a byte too many");
+    for (size_t offset : {0ul, 4ul, 10ul, 30ul, 33ul, good.size() - 10, good.size() - 1}) {
+        std::string flipped = good;
+        flipped[offset] ^= 0x01;
+        rejected(flipped, ("a flipped bit at byte " + std::to_string(offset)).c_str());
+    }
+
+    // A different hour count gets a valid checksum, so only the count check can catch it
+    std::string hours = good.substr(0, good.size() - 4);
+    hours[32] = Forecast::kHours - 1;
+    uint32_t hash = 2166136261u;
+    for (char c : hours) {
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    for (int i = 0; i < 4; i++) {
+        hours.push_back((char)((hash >> (i * 8)) & 0xff));
+    }
+    rejected(hours, "the wrong hour count");
+
+    std::remove(path.c_str());
+    Forecast forecast;
+    CHECK(!loadForecastCache(path, fetched, forecast));
+    // The directory does not exist, so there is nowhere to write the temporary file
+    CHECK(!saveForecastCache("weather_test_missing_dir/cache.bin", cacheableForecast(fetched)));
+}
+
+// One WeatherService polling one path of the stub server, with its own metrics
+struct ServiceUnderTest {
+    FrameTimings timings;
+    MatrixDriver driver{nullptr, nullptr, 1, 1};
+    MatrixOutput output{driver, 1, 1};
+    ClockMetrics metrics{timings, output};
+    std::unique_ptr<WeatherService> service;
+
+    ServiceUnderTest(int port, const std::string &path) {
+        std::string url = "--weather-url=http://127.0.0.1:" + std::to_string(port) + path;
+        const char* argv[] = {"led_matrix_clock", url.c_str(), "--weather-timeout=1", "--weather-cache="};
+        WeatherOptions options = WeatherOptions::FromArgs(4, (char**)argv);
+        // FromArgs() will not go below 10 s; the tests want a second poll sooner
+        options.refreshInterval = seconds(1);
+        service = std::make_unique<WeatherService>(options, &metrics);
+    }
+
+    uint64_t fetches() const {
+        return metrics.toJson()["weather"]["fetches"];
+    }
+
+    uint64_t failures() const {
+        return metrics.toJson()["weather"]["failures"];
+    }
+};
+
+void testServiceAgainstStubServer() {
+    httplib::Server server;
+    std::atomic<int> flakyRequests{0};
+    std::atomic<int> conditionalRequests{0};
+    std::atomic<bool> sawIfNoneMatch{false};
+
+    server.Get("/ok", [](const httplib::Request &, httplib::Response &res) {
+        res.set_content(forecastBody(70), "application/json");
+    });
+    server.Get("/slow", [](const httplib::Request &, httplib::Response &res) {
+        // Latency well inside the 1 s timeout
+        std::this_thread::sleep_for(milliseconds(300));
+        res.set_content(forecastBody(71), "application/json");
+    });
+    server.Get("/error", [](const httplib::Request &, httplib::Response &res) {
+        res.status = 503;
+        res.set_content("upstream unavailable", "text/plain");
+    });
+    server.Get("/hang", [](const httplib::Request &, httplib::Response &res) {
+        std::this_thread::sleep_for(seconds(3));
+        res.set_content(forecastBody(72), "application/json");
+    });
+    server.Get("/garbage", [](const httplib::Request &, httplib::Response &res) {
+        std::string body = forecastBody(73);
+        res.set_content(body.substr(0, body.size() / 2), "application/json");
+    });
+    server.Get("/flaky", [&](const httplib::Request &, httplib::Response &res) {
+        if (flakyRequests++ == 0) {
+            res.set_content(forecastBody(74), "application/json");
+        } else {
+            res.status = 500;
+        }
+    });
+    server.Get("/conditional", [&](const httplib::Request &req, httplib::Response &res) {
+        conditionalRequests++;
+        if (req.get_header_value("If-None-Match") == "\"v1\"") {
+            sawIfNoneMatch = true;
+            res.status = 304;
+            return;
+        }
+        res.set_header("ETag", "\"v1\"");
+        res.set_content(forecastBody(75), "application/json");
+    });
+
+    int port = server.bind_to_any_port("127.0.0.1");
+    CHECK(port > 0);
+    std::thread listener([&]() { server.listen_after_bind(); });
+    server.wait_until_ready();
+
+    const char* paths[] = {"/ok", "/slow", "/error", "/hang", "/garbage", "/flaky", "/conditional"};
+    std::vector<std::unique_ptr<ServiceUnderTest>> services;
+    for (const char* path : paths) {
+        services.push_back(std::make_unique<ServiceUnderTest>(port, path));
+        services.back()->service->start();
+    }
+    ServiceUnderTest &ok = *services[0];
+    ServiceUnderTest &slow = *services[1];
+    ServiceUnderTest &error = *services[2];
+    ServiceUnderTest &hang = *services[3];
+    ServiceUnderTest &garbage = *services[4];
+    ServiceUnderTest &flaky = *services[5];
+    ServiceUnderTest &conditional = *services[6];
+
+    // The first poll comes within 3 s; the ones in between a second or so later
+    const milliseconds patience(10000);
+
+    CHECK(waitFor([&]() { return ok.fetches() >= 1; }, patience));
+    CHECK_EQ(ok.failures(), 0u);
+    CHECK(ok.service->latest()->fetchedMillis != 0);
+    CHECK_EQ(ok.service->latest()->temperatures[0], 70);
+    // The hourly series steps by one degree an hour
+    CHECK_EQ(ok.service->latest()->temperatures[2] - ok.service->latest()->temperatures[1], 1);
+    CHECK(ok.service->latest()->type == WeatherType::cloudy_rain);
+
+    CHECK(waitFor([&]() { return slow.fetches() >= 1; }, patience));
+    CHECK_EQ(slow.failures(), 0u);
+    CHECK_EQ(slow.service->latest()->temperatures[0], 71);
+
+    // Failures leave the placeholder in place
+    CHECK(waitFor([&]() { return error.fetches() >= 1; }, patience));
+    CHECK_EQ(error.failures(), 1u);
+    CHECK_EQ(error.service->latest()->fetchedMillis, 0u);
+
+    CHECK(waitFor([&]() { return hang.fetches() >= 1; }, patience));
+    CHECK_EQ(hang.failures(), 1u);
+    CHECK_EQ(hang.service->latest()->fetchedMillis, 0u);
+    // Gave up at the timeout instead of waiting out the response
+    uint64_t hangLatencyUs = hang.metrics.toJson()["weather"]["latency"]["max_us"];
+    CHECK(hangLatencyUs >= 900000 && hangLatencyUs < 2500000);
+
+    CHECK(waitFor([&]() { return garbage.fetches() >= 1; }, patience));
+    CHECK_EQ(garbage.failures(), 1u);
+    CHECK_EQ(garbage.service->latest()->fetchedMillis, 0u);
+
+    // A failure after a good poll keeps the good forecast published
+    CHECK(waitFor([&]() { return flaky.fetches() >= 2; }, patience));
+    CHECK_EQ(flaky.failures(), 1u);
+    CHECK(flaky.service->latest()->fetchedMillis != 0);
+    CHECK_EQ(flaky.service->latest()->temperatures[0], 74);
+
+    // A 304 re-decodes the previous body and counts as a success
+    CHECK(waitFor([&]() { return conditional.fetches() >= 2; }, patience));
+    CHECK(sawIfNoneMatch);
+    CHECK_EQ(conditional.failures(), 0u);
+    CHECK_EQ(conditional.service->latest()->temperatures[0], 75);
+
+    // stop() must not wait for the backoff (at least 5 s after the failures above)
+    auto stopStart = std::chrono::steady_clock::now();
+    for (auto &entry : services) {
+        entry->service->stop();
+    }
+    CHECK(std::chrono::steady_clock::now() - stopStart < seconds(3));
+
+    server.stop();
+    listener.join();
+}
+
+}  // namespace
+
+int main() {
+    testPollScheduleSuccess();
+    testPollScheduleBackoff();
+    testPollScheduleJitterSpreadsRetries();
+    testIsStale();
+    testFromArgs();
+    testForecastCacheRoundTrip();
+    testForecastCacheRejectsDamage();
+    testServiceAgainstStubServer();
+    if (checks::failures() == 0) {
+        std::cout << "weather_test: all checks passed" << std::endl;
+    }
+    return checks::failures();
+}